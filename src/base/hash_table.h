@@ -157,8 +157,9 @@ hash_table_push_u32_u32(Arena *arena, Hash_Table *table, u32 key, u32 value) {
     return new_node;
 }
 
+// Finds the node for key or appends one, the caller sets the value either way
 internal Bucket_Node *
-hash_table_push_string_string(Arena *arena, Hash_Table *table, String key, String value) {
+hash_table_upsert_string(Arena *arena, Hash_Table *table, String key) {
     u64 hash = hash_key_string(key);
     u64 idx = hash % table->cap;
 
@@ -167,7 +168,6 @@ hash_table_push_string_string(Arena *arena, Hash_Table *table, String key, Strin
     // Check if key already exists
     for (Bucket_Node *node = bucket->first; node; node = node->next) {
         if (str_match(node->v.key_string, key)) {
-            node->v.value_string = value;
             return node;
         }
     }
@@ -175,7 +175,6 @@ hash_table_push_string_string(Arena *arena, Hash_Table *table, String key, Strin
     // Add new node
     Bucket_Node *new_node = push_array(arena, Bucket_Node, 1);
     new_node->v.key_string = key;
-    new_node->v.value_string = value;
     new_node->next = NULL;
 
     if (!bucket->first) {
@@ -189,6 +188,20 @@ hash_table_push_string_string(Arena *arena, Hash_Table *table, String key, Strin
     return new_node;
 }
 
+internal Bucket_Node *
+hash_table_push_string_string(Arena *arena, Hash_Table *table, String key, String value) {
+    Bucket_Node *node = hash_table_upsert_string(arena, table, key);
+    node->v.value_string = value;
+    return node;
+}
+
+internal Bucket_Node *
+hash_table_push_string_u64(Arena *arena, Hash_Table *table, String key, u64 value) {
+    Bucket_Node *node = hash_table_upsert_string(arena, table, key);
+    node->v.value_u64 = value;
+    return node;
+}
+
 internal Key_Value_Pair *
 hash_table_search_u64(Hash_Table *table, u64 key) {
     u64 hash = hash_key_u64(key);
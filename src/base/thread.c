@@ -18,7 +18,7 @@ thread_pool_worker_main(void *arg) {
             break;
 
         while (pool->task_left > 0) {
-            u64 task_index = ins_atomic_u64_dec_eval(&pool->task_left) - 1;
+            u64 task_index = ins_atomic_u64_dec_eval(&pool->task_left);
 
             if (task_index < pool->task_count) {
                 pool->task_func(pool->task_arena->arenas[worker->id],
@@ -34,29 +34,30 @@ thread_pool_worker_main(void *arg) {
     }
 }
 
-internal Thread_Pool
+internal Thread_Pool *
 thread_pool_alloc(Arena *arena, u32 worker_count, u32 max_worker_count, String name) {
-    Thread_Pool pool = {0};
+    // Workers keep a pointer to the pool, so it has to outlive this call
+    Thread_Pool *pool = push_struct_zero(arena, Thread_Pool);
 
     if (worker_count == 0) {
         Sys_Info info = os_get_system_info();
         worker_count = info.num_threads;
     }
 
-    worker_count = Min(worker_count, max_worker_count);
+    worker_count = Max(Min(worker_count, max_worker_count), 1);
 
-    pool.is_live = 1;
-    pool.worker_count = worker_count;
-    pool.workers = push_array(arena, Thread_Pool_Worker, worker_count);
+    pool->is_live = 1;
+    pool->worker_count = worker_count;
+    pool->workers = push_array(arena, Thread_Pool_Worker, worker_count);
 
-    pool.exec_semaphore = os_semaphore_create(0);
-    pool.task_semaphore = os_semaphore_create(1);
-    pool.main_semaphore = os_semaphore_create(0);
+    pool->exec_semaphore = os_semaphore_create(0);
+    pool->task_semaphore = os_semaphore_create(1);
+    pool->main_semaphore = os_semaphore_create(0);
 
     for (u32 i = 0; i < worker_count; i++) {
-        pool.workers[i].id = i;
-        pool.workers[i].pool = &pool;
-        pool.workers[i].handle = os_thread_create(thread_pool_worker_main, &pool.workers[i]);
+        pool->workers[i].id = i;
+        pool->workers[i].pool = pool;
+        pool->workers[i].handle = os_thread_create(thread_pool_worker_main, &pool->workers[i]);
     }
 
     return pool;
@@ -8,7 +8,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 
-#define THREAD_POOL_TASK_FUNC(name) void name(Arena *arena, u64 worker_id, u64 task_id, void *raw_task);
+#define THREAD_POOL_TASK_FUNC(name) void name(Arena *arena, u64 worker_id, u64 task_id, void *raw_task)
 typedef THREAD_POOL_TASK_FUNC(Thread_Pool_Task_Func);
 
 typedef struct Thread_Pool_Arena Thread_Pool_Arena;
@@ -48,7 +48,7 @@ struct Thread_Pool {
     s64                    task_left;
 };
 
-internal Thread_Pool         thread_pool_alloc(Arena *arena, u32 worker_count, u32 max_worker_count, String name);
+internal Thread_Pool        *thread_pool_alloc(Arena *arena, u32 worker_count, u32 max_worker_count, String name);
 internal void                thread_pool_release(Thread_Pool *pool);
 internal Thread_Pool_Arena  *thread_pool_arena_alloc(Thread_Pool *pool);
 internal void                thread_pool_arena_release(Thread_Pool_Arena **arena_ptr);
@@ -0,0 +1,351 @@
+#include "catalog.h"
+#include <stdlib.h>
+
+internal DB_Catalog *
+db_catalog_alloc(void) {
+    Arena      *arena = arena_alloc();
+    DB_Catalog *catalog = push_struct_zero(arena, DB_Catalog);
+    catalog->arena = arena;
+    return catalog;
+}
+
+internal void
+db_catalog_push_schema(DB_Catalog *catalog, DB_Schema schema) {
+    DB_Schema_Node *node = push_struct_zero(catalog->arena, DB_Schema_Node);
+    node->v = schema;
+    DLLPushBack_NPZ(0, catalog->schemas.first, catalog->schemas.last, node, next, prev);
+    catalog->schemas.count++;
+    if (schema.kind == DB_SCHEMA_KIND_TABLE) {
+        catalog->table_count++;
+    }
+}
+
+// The fingerprint is taken first: if the catalog changes while the rest is
+// fetched, the next refresh sees a mismatch instead of missing the change.
+internal DB_Catalog *
+db_catalog_fetch(DB_Conn *conn) {
+    PROF_FUNCTION;
+    DB_Catalog *catalog = db_catalog_alloc();
+    catalog->fingerprint = db_get_catalog_fingerprint(conn);
+
+    // The list lives in the connection's arena, copy it so the catalog can outlive the connection
+    DB_Schema_List schemas = db_get_all_schemas(conn);
+    for (DB_Schema_Node *node = schemas.first; node; node = node->next) {
+        DB_Schema schema = node->v;
+        schema.schema = str_push_copy(catalog->arena, schema.schema);
+        schema.name = str_push_copy(catalog->arena, schema.name);
+        db_catalog_push_schema(catalog, schema);
+    }
+
+    DB_Schema *table_schemas = push_array(catalog->arena, DB_Schema, Max(catalog->table_count, 1));
+    u64        table_index = 0;
+    for (DB_Schema_Node *node = catalog->schemas.first; node; node = node->next) {
+        if (node->v.kind == DB_SCHEMA_KIND_TABLE) {
+            table_schemas[table_index++] = node->v;
+        }
+    }
+
+    // One catalog query for every table, a round trip per table takes minutes on big databases
+    catalog->tables = push_array_zero(catalog->arena, DB_Table *, Max(catalog->table_count, 1));
+    if (!db_get_all_schema_info(conn, table_schemas, catalog->table_count, catalog->tables)) {
+        for (u64 i = 0; i < catalog->table_count; i++) {
+            catalog->tables[i] = db_get_schema_info(conn, table_schemas[i]);
+        }
+    }
+
+    Prof_End();
+    return catalog;
+}
+
+// Tables still in the catalog are freed with it, adopt them by nulling the entry
+internal void
+db_catalog_release(DB_Catalog *catalog) {
+    if (!catalog)
+        return;
+    for (u64 i = 0; i < catalog->table_count; i++) {
+        db_free_schema_info(catalog->tables[i]);
+    }
+    if (catalog->map) {
+        os_file_unmap_view(catalog->map, catalog->map_size);
+    }
+    arena_release(catalog->arena);
+}
+
+// $XDG_CACHE_HOME/dbui, or ~/.cache/dbui, one file per connection string.
+// Empty if neither is set.
+internal String
+db_catalog_cache_path(Arena *arena, String connection_string) {
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char        dir[1024];
+    if (cache_home && cache_home[0]) {
+        snprintf(dir, sizeof(dir), "%s/dbui", cache_home);
+    } else if (home && home[0]) {
+        snprintf(dir, sizeof(dir), "%s/.cache/dbui", home);
+    } else {
+        return str_zero();
+    }
+
+    char path[1200];
+    u64  hash = XXH3_64bits(connection_string.data, connection_string.size);
+    snprintf(path, sizeof(path), "%s/catalog_%016llx.bin", dir, (unsigned long long)hash);
+    return str_push_copy(arena, cstr_to_string(path, strlen(path)));
+}
+
+////////////////////////////////
+// Writing
+
+typedef struct DB_Catalog_Cache_Writer DB_Catalog_Cache_Writer;
+struct DB_Catalog_Cache_Writer {
+    u8                      *strings; // Null while only measuring
+    u64                      string_size;
+    DB_Catalog_Cache_Schema *schemas;
+    DB_Catalog_Cache_Column *columns;
+    u32                      schema_count;
+    u32                      column_count;
+};
+
+internal DB_Catalog_Cache_String
+db_catalog_cache_put_string(DB_Catalog_Cache_Writer *writer, String string) {
+    DB_Catalog_Cache_String result = {(u32)writer->string_size, string.size};
+    if (writer->strings) {
+        MemoryCopy(writer->strings + writer->string_size, string.data, string.size);
+        writer->strings[writer->string_size + string.size] = 0;
+    }
+    writer->string_size += string.size + 1;
+    return result;
+}
+
+internal DB_Catalog_Cache_String
+db_catalog_cache_put_cstring(DB_Catalog_Cache_Writer *writer, char *cstring) {
+    return db_catalog_cache_put_string(writer, cstr_to_string(cstring, cstring ? strlen(cstring) : 0));
+}
+
+// Runs twice, once to measure and once to fill the sections
+internal void
+db_catalog_cache_put_catalog(DB_Catalog_Cache_Writer *writer, DB_Catalog *catalog) {
+    u64 table_index = 0;
+    for (DB_Schema_Node *node = catalog->schemas.first; node; node = node->next) {
+        DB_Catalog_Cache_Schema schema = {0};
+        schema.kind = node->v.kind;
+        schema.schema = db_catalog_cache_put_string(writer, node->v.schema);
+        schema.name = db_catalog_cache_put_string(writer, node->v.name);
+        schema.first_column = writer->column_count;
+        schema.column_count = DB_CATALOG_CACHE_NO_INFO;
+
+        DB_Table *table = node->v.kind == DB_SCHEMA_KIND_TABLE ? catalog->tables[table_index++] : 0;
+        if (table) {
+            schema.column_count = (u32)table->column_count;
+            for (u64 i = 0; i < table->column_count; i++) {
+                DB_Column_Info         *col = dyn_array_get(&table->columns, DB_Column_Info, i);
+                DB_Catalog_Cache_Column column = {0};
+                column.column_name = db_catalog_cache_put_string(writer, col->column_name);
+                column.data_type = db_catalog_cache_put_string(writer, col->data_type);
+                column.is_nullable = db_catalog_cache_put_string(writer, col->is_nullable);
+                column.column_default = db_catalog_cache_put_string(writer, col->column_default);
+                column.is_foreign_key = db_catalog_cache_put_string(writer, col->is_foreign_key);
+                column.foreign_schema_name = db_catalog_cache_put_string(writer, col->foreign_schema_name);
+                column.foreign_table_name = db_catalog_cache_put_string(writer, col->foreign_table_name);
+                column.foreign_column_name = db_catalog_cache_put_string(writer, col->foreign_column_name);
+                column.display_text = db_catalog_cache_put_cstring(writer, col->display_text);
+                column.fk_display = db_catalog_cache_put_cstring(writer, col->fk_display);
+                column.is_fk = col->is_fk;
+                if (writer->columns) {
+                    writer->columns[writer->column_count] = column;
+                }
+                writer->column_count++;
+            }
+        }
+
+        if (writer->schemas) {
+            writer->schemas[writer->schema_count] = schema;
+        }
+        writer->schema_count++;
+    }
+}
+
+// Written to a temporary file and renamed over the old one, so a running
+// instance that has the old file mapped keeps reading the old contents.
+internal b32
+db_catalog_cache_write(DB_Catalog *catalog, String path) {
+    PROF_FUNCTION;
+    if (!path.size) {
+        Prof_End();
+        return 0;
+    }
+
+    DB_Catalog_Cache_Writer measure = {0};
+    db_catalog_cache_put_catalog(&measure, catalog);
+
+    u64 string_size = AlignPow2(measure.string_size, 4);
+    u64 total_size = sizeof(DB_Catalog_Cache_Header) +
+                     measure.schema_count * sizeof(DB_Catalog_Cache_Schema) +
+                     measure.column_count * sizeof(DB_Catalog_Cache_Column) +
+                     string_size;
+    if (string_size > 0xFFFFFFFFull) {
+        log_error("Catalog too large to cache");
+        Prof_End();
+        return 0;
+    }
+
+    Arena *arena = arena_alloc_default(total_size + KB(64), arena_default_commit_size, __FILE__, __LINE__);
+    u8    *data = push_array_zero(arena, u8, total_size);
+
+    DB_Catalog_Cache_Header *header = (DB_Catalog_Cache_Header *)data;
+    header->magic = DB_CATALOG_CACHE_MAGIC;
+    header->version = DB_CATALOG_CACHE_VERSION;
+    header->fingerprint = catalog->fingerprint;
+    header->schema_count = measure.schema_count;
+    header->column_count = measure.column_count;
+    header->string_size = string_size;
+
+    DB_Catalog_Cache_Writer writer = {0};
+    writer.schemas = (DB_Catalog_Cache_Schema *)(header + 1);
+    writer.columns = (DB_Catalog_Cache_Column *)(writer.schemas + measure.schema_count);
+    writer.strings = (u8 *)(writer.columns + measure.column_count);
+    db_catalog_cache_put_catalog(&writer, catalog);
+
+    // Directory part of path, created on first write
+    u32 dir_size = path.size;
+    while (dir_size > 0 && path.data[dir_size - 1] != '/') {
+        dir_size--;
+    }
+    if (dir_size > 0) {
+        os_create_directory_recursive(str(path.data, dir_size));
+    }
+
+    char tmp_path[1300];
+    char final_path[1200];
+    snprintf(final_path, sizeof(final_path), "%.*s", (int)path.size, (char *)path.data);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%u.tmp", final_path, os_thread_get_id());
+
+    b32 written = os_write_entire_file(cstr_to_string(tmp_path, strlen(tmp_path)), str(data, (u32)total_size));
+    if (written && rename(tmp_path, final_path) != 0) {
+        remove(tmp_path);
+        written = 0;
+    }
+    if (!written) {
+        log_error("Failed to write catalog cache {s}", final_path);
+    }
+
+    arena_release(arena);
+    Prof_End();
+    return written;
+}
+
+////////////////////////////////
+// Loading
+
+// Out of range references come back empty, a damaged file can't point outside the view
+internal String
+db_catalog_cache_string(u8 *strings, u64 string_size, DB_Catalog_Cache_String string) {
+    if ((u64)string.offset + string.size + 1 > string_size) {
+        return str_zero();
+    }
+    return str(strings + string.offset, string.size);
+}
+
+// Maps the file and builds the catalog around it, null if it is missing or
+// doesn't look like a cache this build wrote
+internal DB_Catalog *
+db_catalog_cache_load(String path) {
+    PROF_FUNCTION;
+    u64 size = 0;
+    u8 *data = path.size ? (u8 *)os_file_map_view(path, &size) : 0;
+    if (!data) {
+        Prof_End();
+        return 0;
+    }
+
+    DB_Catalog_Cache_Header *header = (DB_Catalog_Cache_Header *)data;
+    b32                      valid = size >= sizeof(*header) &&
+                header->magic == DB_CATALOG_CACHE_MAGIC &&
+                header->version == DB_CATALOG_CACHE_VERSION &&
+                size == sizeof(*header) +
+                            (u64)header->schema_count * sizeof(DB_Catalog_Cache_Schema) +
+                            (u64)header->column_count * sizeof(DB_Catalog_Cache_Column) +
+                            header->string_size;
+    if (!valid) {
+        os_file_unmap_view(data, size);
+        Prof_End();
+        return 0;
+    }
+
+    DB_Catalog_Cache_Schema *schemas = (DB_Catalog_Cache_Schema *)(header + 1);
+    DB_Catalog_Cache_Column *columns = (DB_Catalog_Cache_Column *)(schemas + header->schema_count);
+    u8                      *strings = (u8 *)(columns + header->column_count);
+    u64                      string_size = header->string_size;
+
+    DB_Catalog *catalog = db_catalog_alloc();
+    catalog->fingerprint = header->fingerprint;
+    catalog->map = data;
+    catalog->map_size = size;
+
+    for (u32 i = 0; i < header->schema_count; i++) {
+        DB_Schema schema = {0};
+        schema.kind = (DB_Schema_Kind)schemas[i].kind;
+        schema.schema = db_catalog_cache_string(strings, string_size, schemas[i].schema);
+        schema.name = db_catalog_cache_string(strings, string_size, schemas[i].name);
+        db_catalog_push_schema(catalog, schema);
+    }
+
+    catalog->tables = push_array_zero(catalog->arena, DB_Table *, Max(catalog->table_count, 1));
+    u64 table_index = 0;
+    u32 i = 0;
+    for (DB_Schema_Node *node = catalog->schemas.first; node; node = node->next, i++) {
+        if (node->v.kind != DB_SCHEMA_KIND_TABLE) {
+            continue;
+        }
+
+        DB_Catalog_Cache_Schema *entry = &schemas[i];
+        u64                      index = table_index++;
+        if (entry->column_count == DB_CATALOG_CACHE_NO_INFO ||
+            (u64)entry->first_column + entry->column_count > header->column_count) {
+            continue;
+        }
+
+        // Strings stay in the view, only the column array is built
+        DB_Table *table = db_table_alloc(node->v);
+        for (u32 c = 0; c < entry->column_count; c++) {
+            DB_Catalog_Cache_Column *column = &columns[entry->first_column + c];
+            DB_Column_Info          *col = dyn_array_push(table->arena, &table->columns, DB_Column_Info);
+            *col = (DB_Column_Info){0};
+            col->column_name = db_catalog_cache_string(strings, string_size, column->column_name);
+            col->data_type = db_catalog_cache_string(strings, string_size, column->data_type);
+            col->is_nullable = db_catalog_cache_string(strings, string_size, column->is_nullable);
+            col->column_default = db_catalog_cache_string(strings, string_size, column->column_default);
+            col->is_foreign_key = db_catalog_cache_string(strings, string_size, column->is_foreign_key);
+            col->foreign_schema_name = db_catalog_cache_string(strings, string_size, column->foreign_schema_name);
+            col->foreign_table_name = db_catalog_cache_string(strings, string_size, column->foreign_table_name);
+            col->foreign_column_name = db_catalog_cache_string(strings, string_size, column->foreign_column_name);
+
+            // Blob strings are NUL terminated, so the C string fields can point into it
+            String display_text = db_catalog_cache_string(strings, string_size, column->display_text);
+            String fk_display = db_catalog_cache_string(strings, string_size, column->fk_display);
+            col->display_text = display_text.data ? (char *)display_text.data : "";
+            col->is_fk = column->is_fk;
+            col->fk_display = (col->is_fk && fk_display.data) ? (char *)fk_display.data : NULL;
+            table->column_count++;
+        }
+        catalog->tables[index] = table;
+    }
+
+    Prof_End();
+    return catalog;
+}
+
+// Worker side of DB_REQUEST_CATALOG. Null when the server still matches
+// fingerprint, otherwise the fresh catalog, already written to cache_path.
+internal DB_Catalog *
+db_catalog_refresh(DB_Conn *conn, u64 fingerprint, String cache_path) {
+    u64 current = db_get_catalog_fingerprint(conn);
+    if (!current || current == fingerprint) {
+        return 0;
+    }
+
+    DB_Catalog *catalog = db_catalog_fetch(conn);
+    if (catalog) {
+        db_catalog_cache_write(catalog, cache_path);
+    }
+    return catalog;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "dbui.h"
+
+// On-disk catalog cache, one file per connection string. The file is mapped
+// read-only and used in place: loaded schemas and column info point straight
+// into the view, so startup only allocates the lists and tables around them.
+//
+// Layout: header, schemas[schema_count], columns[column_count], then the
+// string blob. Strings are NUL terminated in the blob so the char * display
+// fields can point into it too. Everything is 4 byte aligned.
+
+#define DB_CATALOG_CACHE_MAGIC   0x43434244 // "DBCC"
+#define DB_CATALOG_CACHE_VERSION 2
+#define DB_CATALOG_CACHE_NO_INFO 0xFFFFFFFF // column_count of a table without column info
+
+typedef struct DB_Catalog_Cache_String DB_Catalog_Cache_String;
+struct DB_Catalog_Cache_String {
+    u32 offset; // Into the string blob
+    u32 size;   // Without the NUL
+};
+
+typedef struct DB_Catalog_Cache_Header DB_Catalog_Cache_Header;
+struct DB_Catalog_Cache_Header {
+    u32 magic;
+    u32 version;
+    u64 fingerprint;
+    u32 schema_count;
+    u32 column_count;
+    u64 string_size;
+};
+
+typedef struct DB_Catalog_Cache_Schema DB_Catalog_Cache_Schema;
+struct DB_Catalog_Cache_Schema {
+    u32                     kind; // DB_Schema_Kind
+    u32                     first_column;
+    u32                     column_count; // DB_CATALOG_CACHE_NO_INFO for tables we had no info for
+    DB_Catalog_Cache_String schema;
+    DB_Catalog_Cache_String name;
+};
+
+typedef struct DB_Catalog_Cache_Column DB_Catalog_Cache_Column;
+struct DB_Catalog_Cache_Column {
+    DB_Catalog_Cache_String column_name;
+    DB_Catalog_Cache_String data_type;
+    DB_Catalog_Cache_String is_nullable;
+    DB_Catalog_Cache_String column_default;
+    DB_Catalog_Cache_String is_foreign_key;
+    DB_Catalog_Cache_String foreign_schema_name;
+    DB_Catalog_Cache_String foreign_table_name;
+    DB_Catalog_Cache_String foreign_column_name;
+    DB_Catalog_Cache_String display_text;
+    DB_Catalog_Cache_String fk_display;
+    u32                     is_fk;
+};
+
+internal DB_Catalog *db_catalog_fetch(DB_Conn *conn);
+internal void        db_catalog_release(DB_Catalog *catalog);
+internal String      db_catalog_cache_path(Arena *arena, String connection_string);
+internal b32         db_catalog_cache_write(DB_Catalog *catalog, String path);
+internal DB_Catalog *db_catalog_cache_load(String path);
+internal DB_Catalog *db_catalog_refresh(DB_Conn *conn, u64 fingerprint, String cache_path);
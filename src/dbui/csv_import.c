@@ -0,0 +1,295 @@
+#include "csv_import.h"
+
+// Position after the first newline outside quotes at or after pos, end if there is none
+internal u64
+csv_import_next_record(u8 *data, u64 pos, u64 end, b32 in_quotes) {
+    for (; pos < end; pos++) {
+        if (data[pos] == '"') {
+            in_quotes = !in_quotes;
+        } else if (data[pos] == '\n' && !in_quotes) {
+            return pos + 1;
+        }
+    }
+    return end;
+}
+
+// Fields of one record, unquoted. Embedded "" come out as a single quote.
+internal String *
+csv_import_parse_fields(Arena *arena, String line, u64 *out_count) {
+    if (line.size && line.data[line.size - 1] == '\n') {
+        line.size--;
+    }
+    if (line.size && line.data[line.size - 1] == '\r') {
+        line.size--;
+    }
+
+    u64 count = 1;
+    b32 in_quotes = 0;
+    for (u64 i = 0; i < line.size; i++) {
+        if (line.data[i] == '"') {
+            in_quotes = !in_quotes;
+        } else if (line.data[i] == ',' && !in_quotes) {
+            count++;
+        }
+    }
+
+    String *fields = push_array_zero(arena, String, count);
+    u8     *out = push_array(arena, u8, line.size + 1);
+    u64     field = 0;
+    u64     at = 0;
+    fields[0].data = out;
+    in_quotes = 0;
+    for (u64 i = 0; i < line.size; i++) {
+        u8 ch = line.data[i];
+        if (ch == '"') {
+            if (in_quotes && i + 1 < line.size && line.data[i + 1] == '"') {
+                out[at++] = '"';
+                i++;
+            } else {
+                in_quotes = !in_quotes;
+            }
+        } else if (ch == ',' && !in_quotes) {
+            fields[field].size = (u64)(out + at - fields[field].data);
+            field++;
+            fields[field].data = out + at;
+        } else {
+            out[at++] = ch;
+        }
+    }
+    fields[field].size = (u64)(out + at - fields[field].data);
+    *out_count = count;
+    return fields;
+}
+
+internal THREAD_POOL_TASK_FUNC(csv_import_count_quotes_task) {
+    CSV_Import       *import = (CSV_Import *)raw_task;
+    CSV_Import_Range *range = &import->ranges[task_id];
+    u8               *at = import->data + range->bytes.min;
+    u8               *end = import->data + range->bytes.max;
+    u64               count = 0;
+    while (at < end && (at = (u8 *)memchr(at, '"', (u64)(end - at)))) {
+        count++;
+        at++;
+    }
+    range->quote_count = count;
+}
+
+// Moves the range onto whole records and checks every record has one field per column
+internal THREAD_POOL_TASK_FUNC(csv_import_check_task) {
+    CSV_Import       *import = (CSV_Import *)raw_task;
+    CSV_Import_Range *range = &import->ranges[task_id];
+    u8               *data = import->data;
+    b32               is_last = task_id + 1 == import->range_count;
+
+    // The record starting at a split point belongs to the range before it, so
+    // both sides agree on the boundary
+    u64 start = task_id == 0 ? import->body.min
+                             : csv_import_next_record(data, range->bytes.min, import->body.max, range->starts_in_quotes);
+    u64 end = is_last ? import->body.max
+                      : csv_import_next_record(data, range[1].bytes.min, import->body.max, range[1].starts_in_quotes);
+    range->records = (Rng1_u64){{{start, Max(start, end)}}};
+
+    u64 rows = 0;
+    u64 fields = 1;
+    b32 in_quotes = 0;
+    for (u64 i = start; i < end; i++) {
+        u8 ch = data[i];
+        if (ch == '"') {
+            in_quotes = !in_quotes;
+        } else if (!in_quotes && ch == ',') {
+            fields++;
+        } else if (!in_quotes && ch == '\n') {
+            if (fields != import->column_count && !range->is_bad) {
+                range->is_bad = 1;
+                range->bad_row = rows;
+                range->bad_field_count = fields;
+            }
+            rows++;
+            fields = 1;
+        }
+    }
+    if (in_quotes || (end > start && data[end - 1] != '\n')) {
+        // Last record of the file, without a trailing newline or inside a quote that never closes
+        if ((in_quotes || fields != import->column_count) && !range->is_bad) {
+            range->is_bad = 1;
+            range->bad_row = rows;
+            range->bad_field_count = in_quotes ? 0 : fields;
+        }
+        rows++;
+    }
+    range->row_count = rows;
+}
+
+internal void
+csv_import_fail(CSV_Import *import, char *message) {
+    import->error = str_push_copy(import->arena, cstr_to_string(message, strlen(message)));
+    ins_atomic_u32_eval_assign(&import->state, CSV_IMPORT_STATE_FAILED);
+}
+
+internal void
+csv_import_thread_main(void *ptr) {
+    CSV_Import *import = (CSV_Import *)ptr;
+    Prof_Begin("CsvImportScan");
+
+    import->data = (u8 *)os_file_map_view(import->path, &import->size);
+    if (!import->data) {
+        csv_import_fail(import, "Can't open the file");
+        Prof_End();
+        return;
+    }
+
+    // Header line, after a UTF-8 byte order mark if there is one
+    u64 header_start = 0;
+    if (import->size >= 3 && import->data[0] == 0xEF && import->data[1] == 0xBB && import->data[2] == 0xBF) {
+        header_start = 3;
+    }
+    u64 header_end = csv_import_next_record(import->data, header_start, import->size, 0);
+    import->columns = csv_import_parse_fields(import->arena, str(import->data + header_start, header_end - header_start), &import->column_count);
+    import->body = (Rng1_u64){{{header_end, import->size}}};
+    if (header_end == header_start) {
+        csv_import_fail(import, "The file is empty");
+        Prof_End();
+        return;
+    }
+
+    u64 body_size = import->body.max - import->body.min;
+    u32 range_count = import->pool->worker_count * CSV_IMPORT_TASKS_PER_WORKER;
+    range_count = (u32)Max(Min((u64)range_count, body_size / CSV_IMPORT_MIN_RANGE_SIZE), 1);
+    Rng1_u64 *split = thread_pool_divide_work(import->arena, body_size, range_count);
+    import->range_count = range_count;
+    import->ranges = push_array_zero(import->arena, CSV_Import_Range, range_count);
+    for (u32 i = 0; i < range_count; i++) {
+        import->ranges[i].bytes = (Rng1_u64){{{import->body.min + split[i].min, import->body.min + split[i].max}}};
+    }
+
+    thread_pool_for_parallel(import->pool, import->pool_arena, range_count, csv_import_count_quotes_task, import);
+    u64 quotes_before = 0;
+    for (u32 i = 0; i < range_count; i++) {
+        import->ranges[i].starts_in_quotes = quotes_before & 1;
+        quotes_before += import->ranges[i].quote_count;
+    }
+    if (!ins_atomic_u32_eval(&import->is_live)) {
+        Prof_End();
+        return;
+    }
+    thread_pool_for_parallel(import->pool, import->pool_arena, range_count, csv_import_check_task, import);
+
+    // Records are counted from 1 with the header as record 1
+    u64 rows_before = 0;
+    for (u32 i = 0; i < range_count; i++) {
+        CSV_Import_Range *range = &import->ranges[i];
+        if (range->is_bad) {
+            char               message[128];
+            unsigned long long record = rows_before + range->bad_row + 2;
+            if (range->bad_field_count == 0) {
+                snprintf(message, sizeof(message), "Record %llu has a quote that is never closed", record);
+            } else {
+                snprintf(message, sizeof(message), "Record %llu has %llu fields, the header has %llu", record,
+                         (unsigned long long)range->bad_field_count, (unsigned long long)import->column_count);
+            }
+            csv_import_fail(import, message);
+            Prof_End();
+            return;
+        }
+        rows_before += range->row_count;
+    }
+    import->row_count = rows_before;
+
+    // Whole ranges per slice, so slices also end on record boundaries
+    u32 slice_count = Min(import->connection_count, range_count);
+    import->slices = push_array_zero(import->arena, String, slice_count);
+    import->slice_bytes_sent = push_array_zero(import->arena, u64, Max(slice_count, 1));
+    for (u32 i = 0; i < slice_count; i++) {
+        u64 first = (u64)range_count * i / slice_count;
+        u64 last = (u64)range_count * (i + 1) / slice_count - 1;
+        u64 start = import->ranges[first].records.min;
+        u64 end = import->ranges[last].records.max;
+        if (end > start) {
+            import->slices[import->slice_count++] = str(import->data + start, end - start);
+        }
+    }
+    ins_atomic_u32_eval_assign(&import->state, CSV_IMPORT_STATE_READY);
+    Prof_End();
+}
+
+internal CSV_Import *
+csv_import_start(Thread_Pool *pool, u32 connection_count, DB_Schema schema, String path) {
+    Arena      *arena = arena_alloc();
+    CSV_Import *import = push_struct_zero(arena, CSV_Import);
+    import->arena = arena;
+    import->pool = pool;
+    import->pool_arena = thread_pool_arena_alloc(pool);
+    import->is_live = 1;
+    import->connection_count = Max(connection_count, 1);
+    import->schema = schema;
+    import->schema.schema = str_push_copy(arena, schema.schema);
+    import->schema.name = str_push_copy(arena, schema.name);
+    import->path = str_push_copy(arena, path);
+    import->thread = os_thread_create(csv_import_thread_main, import);
+    return import;
+}
+
+// Sends the slices once the scan is done, UI thread
+internal void
+csv_import_update(CSV_Import *import, DB_Async *async) {
+    if (!import || ins_atomic_u32_eval(&import->state) != CSV_IMPORT_STATE_READY)
+        return;
+
+    if (import->slice_count == 0) {
+        import->state = CSV_IMPORT_STATE_DONE;
+        return;
+    }
+    for (u32 i = 0; i < import->slice_count; i++) {
+        DB_Request request = {0};
+        request.kind = DB_REQUEST_IMPORT;
+        request.schema = import->schema;
+        request.import_data = import->slices[i];
+        request.import_columns = import->columns;
+        request.import_column_count = import->column_count;
+        request.user_data = i;
+        db_async_submit(async, &request);
+    }
+    import->state = CSV_IMPORT_STATE_SENDING;
+}
+
+internal void
+csv_import_on_result(CSV_Import *import, DB_Result *result) {
+    if (!import || import->state != CSV_IMPORT_STATE_SENDING || result->user_data >= import->slice_count)
+        return;
+
+    import->slice_bytes_sent[result->user_data] = result->copy_bytes;
+    if (result->is_partial)
+        return;
+
+    import->slices_done++;
+    import->rows_imported += result->copy_rows;
+    import->slice_failed |= !result->copy_ok;
+    if (import->slices_done == import->slice_count) {
+        import->error = import->slice_failed ? str_lit("Sending failed, rows from slices that went through were kept") : str_zero();
+        import->state = import->slice_failed ? CSV_IMPORT_STATE_FAILED : CSV_IMPORT_STATE_DONE;
+    }
+}
+
+internal u64
+csv_import_bytes_sent(CSV_Import *import) {
+    u64 bytes = 0;
+    for (u32 i = 0; import->state >= CSV_IMPORT_STATE_SENDING && i < import->slice_count; i++) {
+        bytes += import->slice_bytes_sent[i];
+    }
+    return bytes;
+}
+
+// Slices still in flight point into the mapping, only release once they are
+// done or the async workers are gone
+internal void
+csv_import_release(CSV_Import *import) {
+    if (!import)
+        return;
+    ins_atomic_u32_eval_assign(&import->is_live, 0);
+    os_thread_join(import->thread);
+    if (import->data) {
+        os_file_unmap_view(import->data, import->size);
+    }
+    thread_pool_arena_release(&import->pool_arena);
+    arena_release(import->arena);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "dbui.h"
+
+// Bulk CSV import into an existing table. The file is mapped read-only and
+// never copied: a thread of its own splits it at record boundaries and checks
+// the records on the thread pool, then the UI sends one slice per pooled
+// connection as DB_REQUEST_IMPORT requests, each straight from the mapping.
+//
+// Splitting CSV in parallel needs the quote state at every split point. The
+// first pass counts quotes per range, a prefix sum over the counts gives each
+// range's starting state, and the second pass moves the range starts to the
+// next record boundary and checks the records in between.
+//
+// The first line names the columns. Slices commit independently, so a failed
+// slice leaves the others' rows in the table.
+
+#define CSV_IMPORT_TASKS_PER_WORKER 4
+#define CSV_IMPORT_MIN_RANGE_SIZE   MB(1) // Smaller files aren't worth splitting
+
+typedef enum CSV_Import_State {
+    CSV_IMPORT_STATE_SCANNING,
+    CSV_IMPORT_STATE_READY, // Scanned, waiting for the UI to send the slices
+    CSV_IMPORT_STATE_SENDING,
+    CSV_IMPORT_STATE_DONE,
+    CSV_IMPORT_STATE_FAILED,
+} CSV_Import_State;
+
+typedef struct CSV_Import_Range CSV_Import_Range;
+struct CSV_Import_Range {
+    Rng1_u64 bytes;            // Even split of the body, ignores records
+    b32      starts_in_quotes; // Quote state at bytes.min
+    u64      quote_count;      // Pass 1
+    Rng1_u64 records;          // Pass 2: whole records, ranges follow each other without gaps
+    u64      row_count;        // Pass 2
+    b32      is_bad;           // Pass 2: bad_row has the wrong field count, or the file ends in a quote
+    u64      bad_row;          // Within the range
+    u64      bad_field_count;
+};
+
+typedef struct CSV_Import CSV_Import;
+struct CSV_Import {
+    Arena             *arena;
+    Thread_Pool       *pool;
+    Thread_Pool_Arena *pool_arena;
+    OS_Handle          thread;
+    b32                is_live;
+    u32                connection_count; // Slices to cut
+
+    DB_Schema schema;
+    String    path;
+    u8       *data; // Mapped file
+    u64       size;
+    Rng1_u64  body; // Records after the header line
+    String   *columns;
+    u64       column_count;
+
+    u32               range_count;
+    CSV_Import_Range *ranges;
+
+    // Written by the import thread before state moves past SCANNING
+    u32     state; // CSV_Import_State
+    u64     row_count;
+    String  error;
+    u32     slice_count; // One per connection
+    String *slices;
+
+    // UI thread only
+    u64 *slice_bytes_sent;
+    u32  slices_done;
+    b32  slice_failed;
+    u64  rows_imported;
+};
+
+internal CSV_Import *csv_import_start(Thread_Pool *pool, u32 connection_count, DB_Schema schema, String path);
+internal void        csv_import_update(CSV_Import *import, DB_Async *async);
+internal void        csv_import_on_result(CSV_Import *import, DB_Result *result);
+internal u64         csv_import_bytes_sent(CSV_Import *import);
+internal void        csv_import_release(CSV_Import *import);
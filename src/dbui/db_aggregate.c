@@ -0,0 +1,714 @@
+#include "db_aggregate.h"
+
+#define DB_AGGREGATE_ROWS_PER_TASK 4096
+
+// Smallest or largest value so far. Numbers compare as numbers, anything else by bytes.
+typedef struct DB_Aggregate_Extreme DB_Aggregate_Extreme;
+struct DB_Aggregate_Extreme {
+    f64 number;
+    u32 row; // Table row holding it, formatted for the output
+    b32 is_number;
+};
+
+typedef struct DB_Aggregate_State DB_Aggregate_State;
+struct DB_Aggregate_State {
+    u64                  count;    // Non-null values, rows for COUNT(*)
+    u64                  distinct; // Counted by the merge
+    f64                  sum;
+    b32                  has_value;
+    b32                  all_numbers; // Sum and average are only valid while this is set
+    DB_Aggregate_Extreme min;
+    DB_Aggregate_Extreme max;
+};
+
+typedef struct DB_Aggregate_Group DB_Aggregate_Group;
+struct DB_Aggregate_Group {
+    u64 hash;
+    u32 row; // First row with the key, stands for the key
+};
+
+// A (group, value) pair for COUNT(DISTINCT), hash covers both
+typedef struct DB_Aggregate_Pair DB_Aggregate_Pair;
+struct DB_Aggregate_Pair {
+    u64 hash;
+    u32 group;
+    u32 aggregate;
+};
+
+// Open addressing over groups, slots hold group index + 1
+typedef struct DB_Aggregate_Table DB_Aggregate_Table;
+struct DB_Aggregate_Table {
+    Dyn_Array groups; // DB_Aggregate_Group
+    Dyn_Array states; // DB_Aggregate_State, aggregate_count per group
+    u32      *slots;
+    u64       slot_cap;
+    Dyn_Array pairs; // DB_Aggregate_Pair, distinct within the table
+    u64      *pair_slots;
+    u64       pair_slot_cap;
+    u32      *merged; // Partials only: group index in its partition after the merge
+};
+
+typedef struct DB_Aggregate_Task DB_Aggregate_Task;
+struct DB_Aggregate_Task {
+    DB_View            *view;
+    DB_Group_Spec      *spec;
+    u64                 key_columns[DB_GROUP_CAP + 1]; // Group columns, then the pivot column
+    u64                 key_count;
+    Rng1_u64           *ranges;
+    DB_Aggregate_Table *partials; // Per row task
+    u64                 partial_count;
+    DB_Aggregate_Table *partitions; // Per merge task
+    u64                 partition_count;
+};
+
+////////////////////////////////
+// Keys
+
+internal u64
+db_aggregate_hash_key(DB_Row_Page *page, u64 row_in_page, u64 *columns, u64 count) {
+    u64 hash = 0x9E3779B97F4A7C15ull;
+    for (u64 i = 0; i < count; i++) {
+        if (db_page_cell_is_null(page, row_in_page, columns[i])) {
+            // Differs from the empty string
+            hash = XXH3_64bits_withSeed("\0", 1, hash ^ 0xFF51AFD7ED558CCDull);
+        } else {
+            String v = db_page_cell(page, row_in_page, columns[i]);
+            hash = XXH3_64bits_withSeed(v.data, v.size, hash);
+        }
+    }
+    return hash;
+}
+
+internal b32
+db_aggregate_keys_match(DB_View *view, u32 a, u32 b, u64 *columns, u64 count) {
+    u64          a_row, b_row;
+    DB_Row_Page *a_page = db_view_page_of(view, a, &a_row);
+    DB_Row_Page *b_page = db_view_page_of(view, b, &b_row);
+    for (u64 i = 0; i < count; i++) {
+        b32 a_null = db_page_cell_is_null(a_page, a_row, columns[i]);
+        b32 b_null = db_page_cell_is_null(b_page, b_row, columns[i]);
+        if (a_null != b_null)
+            return 0;
+        if (!a_null && !str_match(db_page_cell(a_page, a_row, columns[i]), db_page_cell(b_page, b_row, columns[i])))
+            return 0;
+    }
+    return 1;
+}
+
+// Index of the group with row's key, added with fresh states if it's new
+internal u32
+db_aggregate_group(Arena *arena, DB_Aggregate_Table *table, DB_View *view, u64 *columns, u64 column_count,
+                   u64 aggregate_count, u64 hash, u32 row) {
+    if ((table->groups.count + 1) * 2 > table->slot_cap) {
+        u64  cap = Max(table->slot_cap * 2, 1024);
+        u32 *slots = push_array_zero(arena, u32, cap);
+        for (u64 g = 0; g < table->groups.count; g++) {
+            u64 at = dyn_array_get(&table->groups, DB_Aggregate_Group, g)->hash & (cap - 1);
+            while (slots[at]) {
+                at = (at + 1) & (cap - 1);
+            }
+            slots[at] = (u32)g + 1;
+        }
+        table->slots = slots;
+        table->slot_cap = cap;
+    }
+
+    u64 at = hash & (table->slot_cap - 1);
+    for (; table->slots[at]; at = (at + 1) & (table->slot_cap - 1)) {
+        u32                 g = table->slots[at] - 1;
+        DB_Aggregate_Group *group = dyn_array_get(&table->groups, DB_Aggregate_Group, g);
+        if (group->hash == hash && db_aggregate_keys_match(view, group->row, row, columns, column_count)) {
+            return g;
+        }
+    }
+
+    u32                 g = (u32)table->groups.count;
+    DB_Aggregate_Group *group = dyn_array_push(arena, &table->groups, DB_Aggregate_Group);
+    group->hash = hash;
+    group->row = row;
+    for (u64 a = 0; a < aggregate_count; a++) {
+        DB_Aggregate_State *state = dyn_array_push(arena, &table->states, DB_Aggregate_State);
+        MemoryZeroStruct(state);
+        state->all_numbers = 1;
+    }
+    table->slots[at] = g + 1;
+    return g;
+}
+
+// Adds to the pair set, 1 if the pair wasn't in it yet
+internal b32
+db_aggregate_pair_add(Arena *arena, DB_Aggregate_Table *table, DB_Aggregate_Pair pair) {
+    if ((table->pairs.count + 1) * 2 > table->pair_slot_cap) {
+        u64  cap = Max(table->pair_slot_cap * 2, 1024);
+        u64 *slots = push_array_zero(arena, u64, cap);
+        for (u64 i = 0; i < table->pairs.count; i++) {
+            u64 hash = dyn_array_get(&table->pairs, DB_Aggregate_Pair, i)->hash;
+            u64 at = hash & (cap - 1);
+            while (slots[at]) {
+                at = (at + 1) & (cap - 1);
+            }
+            slots[at] = hash;
+        }
+        table->pair_slots = slots;
+        table->pair_slot_cap = cap;
+    }
+
+    pair.hash += pair.hash == 0; // 0 marks an empty slot
+    u64 at = pair.hash & (table->pair_slot_cap - 1);
+    for (; table->pair_slots[at]; at = (at + 1) & (table->pair_slot_cap - 1)) {
+        if (table->pair_slots[at] == pair.hash)
+            return 0;
+    }
+    table->pair_slots[at] = pair.hash;
+    *dyn_array_push(arena, &table->pairs, DB_Aggregate_Pair) = pair;
+    return 1;
+}
+
+////////////////////////////////
+// Values
+
+internal b32
+db_aggregate_number(DB_Column_Type type, String v, f64 *out) {
+    s64 integer = 0;
+    if (type == DB_COLUMN_TEXT || type == DB_COLUMN_BYTES)
+        return db_view_parse_f64(v, out);
+    if (!db_view_cell_number(type, v, &integer, out))
+        return 0;
+    if (type != DB_COLUMN_FLOAT32 && type != DB_COLUMN_FLOAT64 && type != DB_COLUMN_NUMERIC) {
+        *out = (f64)integer;
+    }
+    return 1;
+}
+
+// Sums of dates or flags mean nothing, Postgres refuses them too
+internal b32
+db_aggregate_type_is_summable(DB_Column_Type type) {
+    return type == DB_COLUMN_TEXT || type == DB_COLUMN_BYTES || type == DB_COLUMN_INT16 || type == DB_COLUMN_INT32 ||
+           type == DB_COLUMN_INT64 || type == DB_COLUMN_FLOAT32 || type == DB_COLUMN_FLOAT64 || type == DB_COLUMN_NUMERIC;
+}
+
+internal s32
+db_aggregate_compare(DB_View *view, u64 column, DB_Aggregate_Extreme a, DB_Aggregate_Extreme b) {
+    if (a.is_number && b.is_number)
+        return a.number < b.number ? -1 : a.number > b.number ? 1 : 0;
+    u64          a_row, b_row;
+    DB_Row_Page *a_page = db_view_page_of(view, a.row, &a_row);
+    DB_Row_Page *b_page = db_view_page_of(view, b.row, &b_row);
+    return db_view_compare_text(db_page_cell(a_page, a_row, column), db_page_cell(b_page, b_row, column));
+}
+
+internal void
+db_aggregate_add(DB_View *view, u64 column, DB_Aggregate_State *state, DB_Aggregate_Extreme value) {
+    state->count++;
+    state->all_numbers &= value.is_number;
+    state->sum += value.is_number ? value.number : 0;
+    if (!state->has_value) {
+        state->has_value = 1;
+        state->min = value;
+        state->max = value;
+        return;
+    }
+    if (db_aggregate_compare(view, column, value, state->min) < 0) {
+        state->min = value;
+    }
+    if (db_aggregate_compare(view, column, value, state->max) > 0) {
+        state->max = value;
+    }
+}
+
+internal void
+db_aggregate_merge(DB_View *view, u64 column, DB_Aggregate_State *into, DB_Aggregate_State *from) {
+    into->count += from->count;
+    if (!from->has_value)
+        return;
+    into->sum += from->sum;
+    into->all_numbers &= from->all_numbers;
+    if (!into->has_value) {
+        into->has_value = 1;
+        into->min = from->min;
+        into->max = from->max;
+        return;
+    }
+    if (db_aggregate_compare(view, column, from->min, into->min) < 0) {
+        into->min = from->min;
+    }
+    if (db_aggregate_compare(view, column, from->max, into->max) > 0) {
+        into->max = from->max;
+    }
+}
+
+////////////////////////////////
+// Tasks
+
+internal THREAD_POOL_TASK_FUNC(db_aggregate_rows_task) {
+    DB_Aggregate_Task  *task = (DB_Aggregate_Task *)raw_task;
+    DB_View            *view = task->view;
+    DB_Group_Spec      *spec = task->spec;
+    DB_Aggregate_Table *partial = &task->partials[task_id];
+
+    for (u64 i = task->ranges[task_id].min; i < task->ranges[task_id].max; i++) {
+        u32          row = view->rows[i];
+        u64          row_in_page;
+        DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+        u64          hash = db_aggregate_hash_key(page, row_in_page, task->key_columns, task->key_count);
+        u32          g = db_aggregate_group(arena, partial, view, task->key_columns, task->key_count, spec->aggregate_count, hash, row);
+        DB_Aggregate_State *states = dyn_array_get(&partial->states, DB_Aggregate_State, g * spec->aggregate_count);
+
+        for (u64 a = 0; a < spec->aggregate_count; a++) {
+            DB_Aggregate *aggregate = &spec->aggregates[a];
+            if (aggregate->column == DB_AGGREGATE_ALL_ROWS) {
+                states[a].count++;
+                continue;
+            }
+            if (db_page_cell_is_null(page, row_in_page, aggregate->column))
+                continue;
+
+            DB_Column_Info      *col = dyn_array_get(&view->table->columns, DB_Column_Info, aggregate->column);
+            String               v = db_page_cell(page, row_in_page, aggregate->column);
+            DB_Aggregate_Extreme value = {0};
+            value.row = row;
+            value.is_number = db_aggregate_number(col->type, v, &value.number);
+            db_aggregate_add(view, aggregate->column, &states[a], value);
+
+            if (aggregate->op == DB_AGGREGATE_COUNT_DISTINCT) {
+                DB_Aggregate_Pair pair = {0};
+                pair.hash = XXH3_64bits_withSeed(v.data, v.size, hash ^ ((a + 1) * 0xC2B2AE3D27D4EB4Full));
+                pair.group = g;
+                pair.aggregate = (u32)a;
+                db_aggregate_pair_add(arena, partial, pair);
+            }
+        }
+    }
+}
+
+internal u64
+db_aggregate_partition_of(u64 hash, u64 partition_count) {
+    // The low bits pick slots, partitions use the high ones
+    return (hash >> 40) % partition_count;
+}
+
+// Merges every partial's groups that hash into this partition, then counts
+// their distinct values. No other task touches these groups.
+internal THREAD_POOL_TASK_FUNC(db_aggregate_merge_task) {
+    DB_Aggregate_Task  *task = (DB_Aggregate_Task *)raw_task;
+    DB_View            *view = task->view;
+    DB_Group_Spec      *spec = task->spec;
+    DB_Aggregate_Table *partition = &task->partitions[task_id];
+    u64                 aggregate_count = spec->aggregate_count;
+
+    for (u64 t = 0; t < task->partial_count; t++) {
+        DB_Aggregate_Table *partial = &task->partials[t];
+        for (u64 g = 0; g < partial->groups.count; g++) {
+            DB_Aggregate_Group *group = dyn_array_get(&partial->groups, DB_Aggregate_Group, g);
+            if (db_aggregate_partition_of(group->hash, task->partition_count) != task_id)
+                continue;
+            u32 merged = db_aggregate_group(arena, partition, view, task->key_columns, task->key_count, aggregate_count,
+                                            group->hash, group->row);
+            partial->merged[g] = merged;
+            DB_Aggregate_State *into = dyn_array_get(&partition->states, DB_Aggregate_State, merged * aggregate_count);
+            DB_Aggregate_State *from = dyn_array_get(&partial->states, DB_Aggregate_State, g * aggregate_count);
+            for (u64 a = 0; a < aggregate_count; a++) {
+                db_aggregate_merge(view, spec->aggregates[a].column, &into[a], &from[a]);
+            }
+        }
+    }
+
+    for (u64 t = 0; t < task->partial_count; t++) {
+        DB_Aggregate_Table *partial = &task->partials[t];
+        for (u64 i = 0; i < partial->pairs.count; i++) {
+            DB_Aggregate_Pair  *pair = dyn_array_get(&partial->pairs, DB_Aggregate_Pair, i);
+            DB_Aggregate_Group *group = dyn_array_get(&partial->groups, DB_Aggregate_Group, pair->group);
+            if (db_aggregate_partition_of(group->hash, task->partition_count) != task_id)
+                continue;
+            DB_Aggregate_Pair merged_pair = *pair;
+            merged_pair.group = partial->merged[pair->group];
+            if (db_aggregate_pair_add(arena, partition, merged_pair)) {
+                DB_Aggregate_State *state = dyn_array_get(&partition->states, DB_Aggregate_State,
+                                                          merged_pair.group * aggregate_count + pair->aggregate);
+                state->distinct++;
+            }
+        }
+    }
+}
+
+////////////////////////////////
+// Output
+
+internal String
+db_aggregate_format(Arena *arena, DB_View *view, DB_Aggregate *aggregate, DB_Aggregate_State *state, b32 *out_is_null) {
+    char buf[64];
+    *out_is_null = 0;
+    if (aggregate->op == DB_AGGREGATE_COUNT || aggregate->op == DB_AGGREGATE_COUNT_DISTINCT) {
+        u64 count = aggregate->op == DB_AGGREGATE_COUNT ? state->count : state->distinct;
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)count);
+        return str_push_copy(arena, cstr_to_string(buf, strlen(buf)));
+    }
+
+    DB_Column_Info *col = dyn_array_get(&view->table->columns, DB_Column_Info, aggregate->column);
+    if (!state->has_value) {
+        *out_is_null = 1;
+        return str_zero();
+    }
+    if (aggregate->op == DB_AGGREGATE_MIN || aggregate->op == DB_AGGREGATE_MAX) {
+        u32          row = aggregate->op == DB_AGGREGATE_MIN ? state->min.row : state->max.row;
+        u64          row_in_page;
+        DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+        return db_page_cell_format(arena, page, row_in_page, aggregate->column, col->type);
+    }
+    if (!state->all_numbers || !db_aggregate_type_is_summable(col->type)) {
+        *out_is_null = 1;
+        return str_zero();
+    }
+
+    f64 value = aggregate->op == DB_AGGREGATE_SUM ? state->sum : state->sum / (f64)state->count;
+    if (value == (f64)(s64)value && value > -9e15 && value < 9e15) {
+        snprintf(buf, sizeof(buf), "%lld", (long long)value);
+    } else {
+        snprintf(buf, sizeof(buf), "%.15g", value);
+    }
+    return str_push_copy(arena, cstr_to_string(buf, strlen(buf)));
+}
+
+internal void
+db_aggregate_push_column(DB_Table *table, String name) {
+    DB_Column_Info *col = dyn_array_push(table->arena, &table->columns, DB_Column_Info);
+    MemoryZeroStruct(col);
+    col->column_name = str_push_copy(table->arena, name);
+    col->type = DB_COLUMN_TEXT;
+    table->column_count++;
+}
+
+internal String
+db_aggregate_name(Arena *arena, DB_View *view, DB_Aggregate *aggregate) {
+    const char *names[] = {"count", "count", "sum", "min", "max", "avg"};
+    char        buf[256];
+    if (aggregate->column == DB_AGGREGATE_ALL_ROWS) {
+        snprintf(buf, sizeof(buf), "count");
+    } else {
+        String column = dyn_array_get(&view->table->columns, DB_Column_Info, aggregate->column)->column_name;
+        snprintf(buf, sizeof(buf), "%s(%s%.*s)", names[aggregate->op], aggregate->op == DB_AGGREGATE_COUNT_DISTINCT ? "distinct " : "",
+                 (int)column.size, (char *)column.data);
+    }
+    return str_push_copy(arena, cstr_to_string(buf, strlen(buf)));
+}
+
+internal void
+db_aggregate_push_key_cells(Arena *arena, DB_Table *out, DB_View *view, u32 row, u64 *columns, u64 count) {
+    u64          row_in_page;
+    DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+    for (u64 i = 0; i < count; i++) {
+        DB_Column_Info *col = dyn_array_get(&view->table->columns, DB_Column_Info, columns[i]);
+        b32             is_null = db_page_cell_is_null(page, row_in_page, columns[i]);
+        db_table_push_cell(out, i, db_page_cell_format(arena, page, row_in_page, columns[i], col->type), is_null);
+    }
+}
+
+internal int
+db_aggregate_pivot_value_compare(const void *a, const void *b) {
+    String x = *(String *)a;
+    String y = *(String *)b;
+    f64    x_number, y_number;
+    if (db_view_parse_f64(x, &x_number) && db_view_parse_f64(y, &y_number))
+        return x_number < y_number ? -1 : x_number > y_number;
+    return db_view_compare_text(x, y);
+}
+
+// One row per group key without the pivot column, one column per pivot value and aggregate
+internal b32
+db_aggregate_pivot(Arena *arena, DB_Aggregate_Task *task, DB_Table *out, String *out_error) {
+    DB_View       *view = task->view;
+    DB_Group_Spec *spec = task->spec;
+    u64            pivot = spec->pivot_column;
+    DB_Column_Type pivot_type = dyn_array_get(&view->table->columns, DB_Column_Info, pivot)->type;
+
+    // Pivot values, sorted
+    Hash_Table *value_index = hash_table_create(arena, 256);
+    String     *values = push_array(arena, String, DB_PIVOT_MAX_COLUMNS);
+    u64         value_count = 0;
+    for (u64 p = 0; p < task->partition_count; p++) {
+        DB_Aggregate_Table *partition = &task->partitions[p];
+        for (u64 g = 0; g < partition->groups.count; g++) {
+            u32          row = dyn_array_get(&partition->groups, DB_Aggregate_Group, g)->row;
+            u64          row_in_page;
+            DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+            String       value = db_page_cell_is_null(page, row_in_page, pivot) ? str_lit("null")
+                                                                                 : db_page_cell_format(arena, page, row_in_page, pivot, pivot_type);
+            if (hash_table_search_string(value_index, value))
+                continue;
+            if (value_count == DB_PIVOT_MAX_COLUMNS) {
+                *out_error = str_lit("The pivot column has more than 64 values");
+                return 0;
+            }
+            values[value_count++] = value;
+            hash_table_push_string_u64(arena, value_index, value, 0);
+        }
+    }
+    qsort(values, value_count, sizeof(String), db_aggregate_pivot_value_compare);
+    for (u64 v = 0; v < value_count; v++) {
+        hash_table_push_string_u64(arena, value_index, values[v], v);
+    }
+
+    for (u64 c = 0; c < spec->group_count; c++) {
+        db_aggregate_push_column(out, dyn_array_get(&view->table->columns, DB_Column_Info, spec->group_columns[c])->column_name);
+    }
+    for (u64 v = 0; v < value_count; v++) {
+        for (u64 a = 0; a < spec->aggregate_count; a++) {
+            char   buf[256];
+            String name = db_aggregate_name(arena, view, &spec->aggregates[a]);
+            snprintf(buf, sizeof(buf), spec->aggregate_count > 1 ? "%.*s %.*s" : "%.*s", (int)values[v].size, (char *)values[v].data,
+                     (int)name.size, (char *)name.data);
+            db_aggregate_push_column(out, cstr_to_string(buf, strlen(buf)));
+        }
+    }
+
+    // Rows by the group columns alone, each cell points at the states of one (row, pivot value) group
+    DB_Aggregate_Table rows = {0};
+    u64                total_groups = 0;
+    for (u64 p = 0; p < task->partition_count; p++) {
+        total_groups += task->partitions[p].groups.count;
+    }
+    DB_Aggregate_State **cells = push_array_zero(arena, DB_Aggregate_State *, Max(total_groups, 1) * value_count);
+    u32                 *row_of_group = push_array(arena, u32, Max(total_groups, 1));
+    for (u64 p = 0, at = 0; p < task->partition_count; p++) {
+        DB_Aggregate_Table *partition = &task->partitions[p];
+        for (u64 g = 0; g < partition->groups.count; g++, at++) {
+            u32          row = dyn_array_get(&partition->groups, DB_Aggregate_Group, g)->row;
+            u64          row_in_page;
+            DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+            u64          hash = db_aggregate_hash_key(page, row_in_page, spec->group_columns, spec->group_count);
+            u32          r = db_aggregate_group(arena, &rows, view, spec->group_columns, spec->group_count, 0, hash, row);
+            String       value = db_page_cell_is_null(page, row_in_page, pivot) ? str_lit("null")
+                                                                                 : db_page_cell_format(arena, page, row_in_page, pivot, pivot_type);
+            u64          v = hash_table_search_string(value_index, value)->value_u64;
+            cells[r * value_count + v] = dyn_array_get(&partition->states, DB_Aggregate_State, g * spec->aggregate_count);
+            row_of_group[r] = row;
+        }
+    }
+
+    for (u64 r = 0; r < rows.groups.count; r++) {
+        db_table_push_row(out);
+        db_aggregate_push_key_cells(arena, out, view, row_of_group[r], spec->group_columns, spec->group_count);
+        for (u64 v = 0; v < value_count; v++) {
+            for (u64 a = 0; a < spec->aggregate_count; a++) {
+                DB_Aggregate_State *states = cells[r * value_count + v];
+                b32                 is_null = 1;
+                String              cell = states ? db_aggregate_format(arena, view, &spec->aggregates[a], &states[a], &is_null) : str_zero();
+                db_table_push_cell(out, spec->group_count + v * spec->aggregate_count + a, cell, is_null);
+            }
+        }
+    }
+    db_table_publish_rows(out, rows.groups.count);
+    return 1;
+}
+
+////////////////////////////////
+// Parsing
+
+// Group columns, an optional pivot column and the aggregates after a colon:
+//   status, owner pivot year: count, sum(size), count(distinct name)
+// Without aggregates it counts rows.
+internal b32
+db_group_spec_parse(Arena *arena, DB_Table *table, String text, DB_Group_Spec *out_spec, String *out_error) {
+    DB_Group_Spec spec = {0};
+    String        rest = db_view_trim(text);
+
+    while (rest.size && rest.data[0] != ':' && !db_view_starts_with_word(rest, str_lit("pivot"))) {
+        String name = db_view_take_name(&rest, ",:");
+        u64    column = db_view_find_column(table, name);
+        if (column == table->column_count) {
+            *out_error = db_view_error(arena, "No column named %.*s", name);
+            return 0;
+        }
+        if (spec.group_count == DB_GROUP_CAP) {
+            *out_error = str_lit("At most 8 group columns");
+            return 0;
+        }
+        spec.group_columns[spec.group_count++] = column;
+        rest = db_view_trim(rest);
+        if (rest.size && rest.data[0] == ',') {
+            rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+        }
+    }
+
+    if (db_view_starts_with_word(rest, str_lit("pivot"))) {
+        rest = db_view_trim(str(rest.data + 5, (u32)(rest.size - 5)));
+        String name = db_view_take_name(&rest, ":");
+        spec.pivot_column = db_view_find_column(table, name);
+        spec.has_pivot = 1;
+        if (spec.pivot_column == table->column_count) {
+            *out_error = db_view_error(arena, "No column named %.*s", name);
+            return 0;
+        }
+        rest = db_view_trim(rest);
+    }
+
+    if (rest.size && rest.data[0] == ':') {
+        rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+        while (rest.size) {
+            struct {
+                const char     *name;
+                DB_Aggregate_Op op;
+            } ops[] = {
+                {"count", DB_AGGREGATE_COUNT},
+                {"sum", DB_AGGREGATE_SUM},
+                {"min", DB_AGGREGATE_MIN},
+                {"max", DB_AGGREGATE_MAX},
+                {"avg", DB_AGGREGATE_AVG},
+            };
+            String function = db_view_take_name(&rest, ",(");
+            u32    op = ArrayCount(ops);
+            for (u32 i = 0; i < ArrayCount(ops); i++) {
+                if (db_view_match_nocase(function, cstr_to_string(ops[i].name, strlen(ops[i].name)))) {
+                    op = i;
+                }
+            }
+            if (op == ArrayCount(ops)) {
+                *out_error = db_view_error(arena, "Unknown aggregate %.*s", function);
+                return 0;
+            }
+            if (spec.aggregate_count == DB_AGGREGATE_CAP) {
+                *out_error = str_lit("At most 16 aggregates");
+                return 0;
+            }
+
+            DB_Aggregate *aggregate = &spec.aggregates[spec.aggregate_count++];
+            aggregate->op = ops[op].op;
+            aggregate->column = DB_AGGREGATE_ALL_ROWS;
+            rest = db_view_trim(rest);
+            if (rest.size && rest.data[0] == '(') {
+                rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+                if (aggregate->op == DB_AGGREGATE_COUNT && db_view_starts_with_word(rest, str_lit("distinct"))) {
+                    aggregate->op = DB_AGGREGATE_COUNT_DISTINCT;
+                    rest = db_view_trim(str(rest.data + 8, (u32)(rest.size - 8)));
+                }
+                if (rest.size && rest.data[0] == '*' && aggregate->op == DB_AGGREGATE_COUNT) {
+                    rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+                } else {
+                    String name = db_view_take_name(&rest, ")");
+                    aggregate->column = db_view_find_column(table, name);
+                    if (aggregate->column == table->column_count) {
+                        *out_error = db_view_error(arena, "No column named %.*s", name);
+                        return 0;
+                    }
+                    rest = db_view_trim(rest);
+                }
+                if (!rest.size || rest.data[0] != ')') {
+                    *out_error = db_view_error(arena, "Expected ) after %.*s", function);
+                    return 0;
+                }
+                rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+            } else if (aggregate->op != DB_AGGREGATE_COUNT) {
+                *out_error = db_view_error(arena, "Expected a column in parentheses after %.*s", function);
+                return 0;
+            }
+
+            if (rest.size && rest.data[0] == ',') {
+                rest = db_view_trim(str(rest.data + 1, (u32)(rest.size - 1)));
+            } else if (rest.size) {
+                break;
+            }
+        }
+    }
+    if (rest.size) {
+        *out_error = db_view_error(arena, "Unexpected %.*s", rest);
+        return 0;
+    }
+
+    if (spec.aggregate_count == 0) {
+        spec.aggregates[0].op = DB_AGGREGATE_COUNT;
+        spec.aggregates[0].column = DB_AGGREGATE_ALL_ROWS;
+        spec.aggregate_count = 1;
+    }
+    *out_spec = spec;
+    return 1;
+}
+
+////////////////////////////////
+// Aggregation
+
+// Null with out_error set if a pivot has too many values. Free the table with db_free_schema_info.
+internal DB_Table *
+db_aggregate(Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_View *view, DB_Group_Spec *spec, String *out_error) {
+    PROF_FUNCTION;
+    Scratch  scratch = tctx_scratch_begin(0, 0);
+    Scratch *worker_scratches = push_array(scratch.arena, Scratch, pool_arena->count);
+    for (u64 i = 0; i < pool_arena->count; i++) {
+        worker_scratches[i] = scratch_begin(pool_arena->arenas[i]);
+    }
+
+    DB_Aggregate_Task task = {0};
+    task.view = view;
+    task.spec = spec;
+    MemoryCopy(task.key_columns, spec->group_columns, sizeof(u64) * spec->group_count);
+    task.key_count = spec->group_count;
+    if (spec->has_pivot) {
+        task.key_columns[task.key_count++] = spec->pivot_column;
+    }
+
+    u64 row_task_count = Min((view->count + DB_AGGREGATE_ROWS_PER_TASK - 1) / DB_AGGREGATE_ROWS_PER_TASK, (u64)pool->worker_count * 4);
+    row_task_count = Max(row_task_count, 1);
+    task.ranges = thread_pool_divide_work(scratch.arena, view->count, (u32)row_task_count);
+    task.partials = push_array_zero(scratch.arena, DB_Aggregate_Table, row_task_count);
+    task.partial_count = row_task_count;
+    thread_pool_for_parallel(pool, pool_arena, row_task_count, db_aggregate_rows_task, &task);
+
+    for (u64 t = 0; t < task.partial_count; t++) {
+        task.partials[t].merged = push_array(scratch.arena, u32, Max(task.partials[t].groups.count, 1));
+    }
+    task.partition_count = Max(pool->worker_count, 1);
+    task.partitions = push_array_zero(scratch.arena, DB_Aggregate_Table, task.partition_count);
+    thread_pool_for_parallel(pool, pool_arena, task.partition_count, db_aggregate_merge_task, &task);
+
+    DB_Table *out = db_table_alloc(view->table->schema);
+    b32       ok = 1;
+    if (spec->has_pivot) {
+        ok = db_aggregate_pivot(scratch.arena, &task, out, out_error);
+    } else {
+        for (u64 c = 0; c < spec->group_count; c++) {
+            db_aggregate_push_column(out, dyn_array_get(&view->table->columns, DB_Column_Info, spec->group_columns[c])->column_name);
+        }
+        for (u64 a = 0; a < spec->aggregate_count; a++) {
+            db_aggregate_push_column(out, db_aggregate_name(scratch.arena, view, &spec->aggregates[a]));
+        }
+
+        u64 row_count = 0;
+        for (u64 p = 0; p < task.partition_count; p++) {
+            DB_Aggregate_Table *partition = &task.partitions[p];
+            for (u64 g = 0; g < partition->groups.count; g++) {
+                DB_Aggregate_State *states = dyn_array_get(&partition->states, DB_Aggregate_State, g * spec->aggregate_count);
+                db_table_push_row(out);
+                db_aggregate_push_key_cells(scratch.arena, out, view, dyn_array_get(&partition->groups, DB_Aggregate_Group, g)->row,
+                                            spec->group_columns, spec->group_count);
+                for (u64 a = 0; a < spec->aggregate_count; a++) {
+                    b32    is_null;
+                    String cell = db_aggregate_format(scratch.arena, view, &spec->aggregates[a], &states[a], &is_null);
+                    db_table_push_cell(out, spec->group_count + a, cell, is_null);
+                }
+                row_count++;
+            }
+        }
+        // Aggregates without groups give one row even over no rows, like SQL
+        if (row_count == 0 && spec->group_count == 0) {
+            DB_Aggregate_State empty = {0};
+            db_table_push_row(out);
+            for (u64 a = 0; a < spec->aggregate_count; a++) {
+                b32    is_null;
+                String cell = db_aggregate_format(scratch.arena, view, &spec->aggregates[a], &empty, &is_null);
+                db_table_push_cell(out, a, cell, is_null);
+            }
+            row_count = 1;
+        }
+        db_table_publish_rows(out, row_count);
+    }
+
+    for (u64 i = 0; i < pool_arena->count; i++) {
+        scratch_end(&worker_scratches[i]);
+    }
+    tctx_scratch_end(scratch);
+    if (!ok) {
+        db_free_schema_info(out);
+        out = 0;
+    }
+    Prof_End();
+    return out;
+}
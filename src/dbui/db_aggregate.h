@@ -0,0 +1,52 @@
+#pragma once
+#include "dbui.h"
+#include "db_view.h"
+
+// Local GROUP BY over the rows of a DB_View. The result is a new DB_Table of
+// text columns, the group columns followed by one column per aggregate, so it
+// can be browsed, filtered and sorted like any fetched table.
+//
+// Each task hashes its share of the rows into a partial table of its own. A
+// group is kept as the first row that had its key, keys are compared cell by
+// cell against that row and never copied. The partials are then merged on the
+// pool as well, split by hash so every task owns a disjoint set of groups.
+//
+// COUNT(DISTINCT) keeps a set of 64 bit hashes of (group, value) pairs, exact
+// unless two values collide on a 64 bit hash. Text columns that only hold
+// numbers sum and compare as numbers, like the filter does.
+//
+// A pivot groups by the pivot column as well, then turns its values into
+// columns, one per value and aggregate.
+
+#define DB_AGGREGATE_ALL_ROWS  ((u64)-1) // COUNT(*)
+#define DB_AGGREGATE_CAP       16
+#define DB_GROUP_CAP           8
+#define DB_PIVOT_MAX_COLUMNS   64
+
+typedef enum DB_Aggregate_Op {
+    DB_AGGREGATE_COUNT,
+    DB_AGGREGATE_COUNT_DISTINCT,
+    DB_AGGREGATE_SUM,
+    DB_AGGREGATE_MIN,
+    DB_AGGREGATE_MAX,
+    DB_AGGREGATE_AVG,
+} DB_Aggregate_Op;
+
+typedef struct DB_Aggregate DB_Aggregate;
+struct DB_Aggregate {
+    DB_Aggregate_Op op;
+    u64             column; // DB_AGGREGATE_ALL_ROWS for COUNT(*)
+};
+
+typedef struct DB_Group_Spec DB_Group_Spec;
+struct DB_Group_Spec {
+    u64          group_columns[DB_GROUP_CAP];
+    u64          group_count;
+    b32          has_pivot;
+    u64          pivot_column;
+    DB_Aggregate aggregates[DB_AGGREGATE_CAP];
+    u64          aggregate_count;
+};
+
+internal b32       db_group_spec_parse(Arena *arena, DB_Table *table, String text, DB_Group_Spec *out_spec, String *out_error);
+internal DB_Table *db_aggregate(Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_View *view, DB_Group_Spec *spec, String *out_error);
@@ -0,0 +1,382 @@
+#include "dbui.h"
+
+// Runs a batch of requests, the driver posts a final result for every one
+internal void
+db_run_requests(DB_Conn *conn, DB_Request *first, b32 *is_live) {
+    switch (conn->kind) {
+    case DB_KIND_POSTGRES:
+        pg_run_requests(conn, first, is_live);
+        break;
+    default:
+        ASSERT(false, "Unimplemented");
+    }
+}
+
+// Caller holds the mutex
+internal DB_Result *
+db_async_push_result(DB_Async *async, DB_Request *request, DB_Table *table, b32 is_partial) {
+    DB_Result *result = async->free_result;
+    if (result) {
+        SLLStackPop_N(async->free_result, next);
+    } else {
+        result = push_struct(async->arena, DB_Result);
+    }
+    MemoryZeroStruct(result);
+    result->ticket = request->ticket;
+    result->kind = request->kind;
+    result->user_data = request->user_data;
+    result->table = table;
+    result->is_partial = is_partial;
+    SLLQueuePush(async->first_result, async->last_result, result);
+    return result;
+}
+
+// Hands a table that is still being filled to the UI, called from the worker
+internal void
+db_async_post_partial(DB_Async *async, DB_Request *request, DB_Table *table) {
+    os_mutex_lock(async->mutex);
+    db_async_push_result(async, request, table, 1);
+    os_mutex_unlock(async->mutex);
+}
+
+// Final result for a request, called from the worker. The request goes back
+// to the free list, so it can't be touched afterwards.
+internal void
+db_async_post_result(DB_Async *async, DB_Request *request, DB_Table *table) {
+    if (table) {
+        ins_atomic_u32_eval_assign(&table->is_streaming, 0);
+    }
+
+    os_mutex_lock(async->mutex);
+    db_async_push_result(async, request, table, 0);
+    SLLStackPush_N(async->free_request, request, next);
+    os_mutex_unlock(async->mutex);
+}
+
+// Reports how far an export or import got, called from the worker
+internal void
+db_async_post_copy_progress(DB_Async *async, DB_Request *request, u64 bytes) {
+    os_mutex_lock(async->mutex);
+    db_async_push_result(async, request, 0, 1)->copy_bytes = bytes;
+    os_mutex_unlock(async->mutex);
+}
+
+// Requests that come back as one short, whole result and can share a pipelined
+// batch. Streamed reads (data, cell values, row estimates) post partial results
+// and would hold up everything behind them, a COPY or catalog refresh runs its
+// own protocol or several blocking queries.
+internal b32
+db_async_request_is_batchable(DB_Request *request) {
+    return request->kind == DB_REQUEST_SCHEMA_INFO || request->kind == DB_REQUEST_TABLE_PAGE;
+}
+
+// Caller holds the mutex. Short requests go out together as one pipelined
+// batch, anything else is taken on its own.
+internal DB_Request *
+db_async_pop_batch(DB_Async *async) {
+    DB_Request *first = async->first_request;
+    if (!first)
+        return 0;
+
+    DB_Request *last = first;
+    if (db_async_request_is_batchable(first)) {
+        while (last->next && db_async_request_is_batchable(last->next)) {
+            last = last->next;
+        }
+    }
+    async->first_request = last->next;
+    if (!async->first_request) {
+        async->last_request = 0;
+    }
+    last->next = 0;
+    return first;
+}
+
+internal void
+db_async_worker_main(void *ptr) {
+    DB_Async_Worker *worker = (DB_Async_Worker *)ptr;
+    DB_Async        *async = worker->async;
+
+    // os_open_file and friends take their scratch from the thread context
+    TCTX tctx = {0};
+    tctx_init_and_equip(&tctx);
+    tctx_set_thread_name(str_lit("db_worker"));
+
+    while (ins_atomic_u32_eval(&async->is_live)) {
+        os_semaphore_wait_timeout(async->wake, 100);
+
+        for (;;) {
+            os_mutex_lock(async->mutex);
+            DB_Request *first = db_async_pop_batch(async);
+            b32         has_more = async->first_request != 0;
+            os_mutex_unlock(async->mutex);
+
+            if (!first) {
+                break;
+            }
+            if (has_more) {
+                // Let an idle worker pick up the rest in parallel
+                os_semaphore_signal(async->wake);
+            }
+
+            // Connections are opened on first use and reset if the server dropped them
+            if (worker->conn && !db_check_connection(worker->conn)) {
+                log_error("DB worker lost its connection, reconnecting");
+                db_disconnect(worker->conn);
+                worker->conn = 0;
+            }
+            if (!worker->conn) {
+                worker->conn = db_connect(async->config);
+                if (!worker->conn) {
+                    log_error("DB worker failed to connect, its queries will fail");
+                }
+            }
+
+            if (worker->conn && ins_atomic_u32_eval(&async->is_live) && first->kind == DB_REQUEST_CATALOG) {
+                DB_Catalog *catalog = db_catalog_refresh(worker->conn, first->fingerprint, first->cache_path);
+                os_mutex_lock(async->mutex);
+                db_async_push_result(async, first, 0, 0)->catalog = catalog;
+                SLLStackPush_N(async->free_request, first, next);
+                os_mutex_unlock(async->mutex);
+            } else if (worker->conn && ins_atomic_u32_eval(&async->is_live) &&
+                       (first->kind == DB_REQUEST_EXPORT || first->kind == DB_REQUEST_IMPORT)) {
+                u64 bytes = 0;
+                u64 rows = 0;
+                b32 ok = first->kind == DB_REQUEST_EXPORT ? db_export(worker->conn, first, &async->is_live, &bytes, &rows)
+                                                          : db_import(worker->conn, first, &async->is_live, &bytes, &rows);
+                os_mutex_lock(async->mutex);
+                DB_Result *result = db_async_push_result(async, first, 0, 0);
+                result->copy_bytes = bytes;
+                result->copy_rows = rows;
+                result->copy_ok = ok;
+                SLLStackPush_N(async->free_request, first, next);
+                os_mutex_unlock(async->mutex);
+            } else if (worker->conn && ins_atomic_u32_eval(&async->is_live)) {
+                db_run_requests(worker->conn, first, &async->is_live);
+            } else {
+                for (DB_Request *request = first, *next = 0; request; request = next) {
+                    next = request->next;
+                    db_async_post_result(async, request, 0);
+                }
+            }
+        }
+    }
+    tctx_release(&tctx);
+}
+
+#define DB_DDL_DEBOUNCE_SECONDS 0.2
+#define DB_DDL_RETRY_MS         2000
+
+// Re-introspects the tables named by a burst of DDL notifications and posts
+// one DB_REQUEST_SCHEMA_CHANGE result per table
+internal void
+db_async_flush_ddl(DB_Async *async, DB_Conn *conn, DB_Schema_List *names) {
+    // The listener has no thread context, the connection arena serves as scratch
+    Scratch     scratch = scratch_begin(conn->arena);
+    Hash_Table *seen = hash_table_create(scratch.arena, names->count * 2 + 1);
+    DB_Schema  *schemas = push_array_zero(scratch.arena, DB_Schema, Max(names->count, 1));
+    u64         count = 0;
+    for (DB_Schema_Node *node = names->first; node; node = node->next) {
+        // A migration names the same table many times
+        String key = db_schema_key(scratch.arena, node->v.schema, node->v.name);
+        if (hash_table_search_string(seen, key)) {
+            continue;
+        }
+        hash_table_push_string_u64(scratch.arena, seen, key, count);
+        schemas[count++] = node->v;
+    }
+
+    DB_Table **tables = push_array_zero(scratch.arena, DB_Table *, Max(count, 1));
+    if (db_get_schema_info_batch(conn, schemas, count, tables)) {
+        os_mutex_lock(async->mutex);
+        for (u64 i = 0; i < count; i++) {
+            // Gone from the catalog, the UI removes the node
+            b32       is_dropped = tables[i] == 0;
+            DB_Table *table = is_dropped ? db_table_alloc(schemas[i]) : tables[i];
+            table->schema.schema = str_push_copy(table->arena, schemas[i].schema);
+            table->schema.name = str_push_copy(table->arena, schemas[i].name);
+
+            DB_Request request = {0};
+            request.kind = DB_REQUEST_SCHEMA_CHANGE;
+            db_async_push_result(async, &request, table, 0)->is_dropped = is_dropped;
+        }
+        os_mutex_unlock(async->mutex);
+    }
+    scratch_end(&scratch);
+}
+
+// Waits for DDL notifications on a connection of its own. Notifications are
+// collected until the burst is over, then only the tables they name are
+// re-introspected.
+internal void
+db_async_listener_main(void *ptr) {
+    DB_Async      *async = (DB_Async *)ptr;
+    Arena         *arena = arena_alloc(); // Collected names, cleared after each flush
+    DB_Schema_List names = {0};
+    f64            last_notify_time = 0;
+
+    while (ins_atomic_u32_eval(&async->is_live)) {
+        if (!async->listener_conn) {
+            async->listener_conn = db_connect(async->config);
+            if (!async->listener_conn || !db_watch_ddl(async->listener_conn, async->listener_install_trigger)) {
+                db_disconnect(async->listener_conn);
+                async->listener_conn = 0;
+                os_semaphore_wait_timeout(async->listener_stop, DB_DDL_RETRY_MS);
+                continue;
+            }
+            async->listener_install_trigger = 0;
+        }
+
+        // Short waits while names are pending, so a burst is flushed soon after it ends
+        u64 pending = names.count;
+        if (!db_wait_ddl(async->listener_conn, arena, pending ? 50 : 250, &names)) {
+            log_error("DDL listener lost its connection, changes until it is back are missed");
+            db_disconnect(async->listener_conn);
+            async->listener_conn = 0;
+            continue;
+        }
+        if (names.count != pending) {
+            last_notify_time = os_get_time();
+        }
+        if (names.count && os_get_time() - last_notify_time >= DB_DDL_DEBOUNCE_SECONDS) {
+            db_async_flush_ddl(async, async->listener_conn, &names);
+            arena_clear(arena);
+            MemoryZeroStruct(&names);
+        }
+    }
+    arena_release(arena);
+}
+
+// worker_count connections at most, each worker opens its own when it first
+// gets a request since libpq connections can't be shared across threads
+internal DB_Async *
+db_async_alloc(DB_Config config, u32 worker_count) {
+    Arena    *arena = arena_alloc();
+    DB_Async *async = push_struct_zero(arena, DB_Async);
+    async->arena = arena;
+    async->config = config;
+    async->config.connection_string = str_push_copy(arena, config.connection_string);
+    async->wake = os_semaphore_create(0);
+    async->listener_stop = os_semaphore_create(0);
+    async->mutex = os_mutex_create();
+    async->is_live = 1;
+    async->worker_count = Max(worker_count, 1);
+    async->workers = push_array_zero(arena, DB_Async_Worker, async->worker_count);
+    for (u32 i = 0; i < async->worker_count; i++) {
+        async->workers[i].async = async;
+        async->workers[i].thread = os_thread_create(db_async_worker_main, &async->workers[i]);
+    }
+    return async;
+}
+
+internal void
+db_async_release(DB_Async *async) {
+    if (!async)
+        return;
+    ins_atomic_u32_eval_assign(&async->is_live, 0);
+    for (u32 i = 0; i < async->worker_count; i++) {
+        os_semaphore_signal(async->wake);
+    }
+    for (u32 i = 0; i < async->worker_count; i++) {
+        os_thread_join(async->workers[i].thread);
+    }
+    if (!os_handle_is_zero(async->listener)) {
+        os_semaphore_signal(async->listener_stop);
+        os_thread_join(async->listener);
+    }
+
+    // Tables nobody polled for yet, a partial result shares its table with the final one
+    for (DB_Result *result = async->first_result; result; result = result->next) {
+        if (!result->is_partial) {
+            db_free_schema_info(result->table);
+        }
+        db_catalog_release(result->catalog);
+    }
+    for (u32 i = 0; i < async->worker_count; i++) {
+        db_disconnect(async->workers[i].conn);
+    }
+    db_disconnect(async->listener_conn);
+    for (DB_Request *request = async->free_request; request; request = request->next) {
+        arena_release(request->arena);
+    }
+    for (DB_Request *request = async->first_request; request; request = request->next) {
+        arena_release(request->arena);
+    }
+    os_mutex_destroy(async->mutex);
+    os_semaphore_destroy(async->wake);
+    os_semaphore_destroy(async->listener_stop);
+    arena_release(async->arena);
+}
+
+// Starts the DDL listener. Changed tables come back through db_async_poll as
+// DB_REQUEST_SCHEMA_CHANGE results without a ticket.
+internal void
+db_async_watch_ddl(DB_Async *async, b32 install_trigger) {
+    if (!os_handle_is_zero(async->listener))
+        return;
+    async->listener_install_trigger = install_trigger;
+    async->listener = os_thread_create(db_async_listener_main, async);
+}
+
+// Queues a copy of params, next/ticket/async are filled in here. The schema,
+// page key, projection and cell strings are copied into the request, so the
+// caller can free them while it's in flight. Export, import and cache paths
+// and data still have to outlive it.
+internal DB_Ticket
+db_async_submit(DB_Async *async, DB_Request *params) {
+    os_mutex_lock(async->mutex);
+    DB_Request *request = async->free_request;
+    if (request) {
+        SLLStackPop_N(async->free_request, next);
+    } else {
+        request = push_struct_zero(async->arena, DB_Request);
+    }
+    os_mutex_unlock(async->mutex);
+
+    Arena *arena = request->arena ? request->arena : arena_alloc();
+    arena_clear(arena);
+    *request = *params;
+    request->next = 0;
+    request->arena = arena;
+    request->schema.schema = str_push_copy(arena, params->schema.schema);
+    request->schema.name = str_push_copy(arena, params->schema.name);
+    for (u32 k = 0; k < Min(params->after.column_count, DB_PAGE_KEY_MAX); k++) {
+        request->after.columns[k] = str_push_copy(arena, params->after.columns[k]);
+        request->after.values[k] = str_push_copy(arena, params->after.values[k]);
+    }
+    request->projection.select_list = str_push_copy(arena, params->projection.select_list);
+    request->cell_column = str_push_copy(arena, params->cell_column);
+    request->cell_locator = str_push_copy(arena, params->cell_locator);
+
+    os_mutex_lock(async->mutex);
+    async->next_ticket += 1;
+    DB_Ticket ticket = async->next_ticket;
+    request->ticket = ticket;
+    request->async = async;
+    SLLQueuePush(async->first_request, async->last_request, request);
+    os_mutex_unlock(async->mutex);
+
+    os_semaphore_signal(async->wake);
+    return ticket;
+}
+
+// Moves every completed result into arena, call once per frame
+internal DB_Result_List
+db_async_poll(DB_Async *async, Arena *arena) {
+    DB_Result_List list = {0};
+    os_mutex_lock(async->mutex);
+    while (async->first_result) {
+        DB_Result *result = async->first_result;
+        SLLQueuePop(async->first_result, async->last_result);
+
+        DB_Result *copy = push_struct(arena, DB_Result);
+        *copy = *result;
+        copy->next = 0;
+        SLLQueuePush(list.first, list.last, copy);
+        list.count++;
+
+        SLLStackPush_N(async->free_result, result, next);
+    }
+    os_mutex_unlock(async->mutex);
+    return list;
+}
@@ -0,0 +1,328 @@
+#include "db_stats.h"
+
+#define DB_STATS_ROWS_PER_TASK 4096
+
+typedef struct DB_Stats_Sample DB_Stats_Sample;
+struct DB_Stats_Sample {
+    u64 hash;
+    f64 number;
+    f64 weight; // Values it stands for, set by the merge
+    u32 row;
+};
+
+// One column over one task's rows, or over all of them once merged
+typedef struct DB_Stats_Column DB_Stats_Column;
+struct DB_Stats_Column {
+    u8                 registers[DB_STATS_HLL_REGISTERS];
+    u64                nulls;
+    DB_Aggregate_State values; // Count, min and max of the non-null ones
+    DB_Stats_Sample   *samples;
+    u64                sample_count;
+};
+
+typedef struct DB_Stats_Task DB_Stats_Task;
+struct DB_Stats_Task {
+    DB_View         *view;
+    u64              column_count;
+    Rng1_u64        *ranges;
+    DB_Stats_Column *partials; // column_count per row task
+    u64              partial_count;
+    DB_Stats_Column *merged;     // Per column
+    f64             *distinct;   // Per column
+    String          *histograms; // Per column, formatted by the merge
+};
+
+////////////////////////////////
+// HyperLogLog
+
+internal void
+db_stats_hll_add(u8 *registers, u64 hash) {
+    // The top bits pick the register, the rank is the position of the first set bit after them.
+    // The marker bit caps it when the rest is all zeros.
+    u64 index = hash >> (64 - DB_STATS_HLL_BITS);
+    u64 rest = (hash << DB_STATS_HLL_BITS) | ((u64)1 << (DB_STATS_HLL_BITS - 1));
+    u8  rank = 1;
+    while (!(rest & 0x8000000000000000ull)) {
+        rest <<= 1;
+        rank++;
+    }
+    registers[index] = Max(registers[index], rank);
+}
+
+internal f64
+db_stats_hll_estimate(u8 *registers) {
+    f64 m = DB_STATS_HLL_REGISTERS;
+    f64 sum = 0;
+    u64 zeros = 0;
+    for (u64 i = 0; i < DB_STATS_HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -(int)registers[i]);
+        zeros += registers[i] == 0;
+    }
+    f64 estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+    // Linear counting is closer while many registers are still empty
+    if (estimate <= 2.5 * m && zeros) {
+        estimate = m * log(m / (f64)zeros);
+    }
+    return estimate;
+}
+
+////////////////////////////////
+// Histograms
+
+internal int
+db_stats_sample_compare(const void *a, const void *b) {
+    u64 x = ((DB_Stats_Sample *)a)->hash;
+    u64 y = ((DB_Stats_Sample *)b)->hash;
+    return x < y ? -1 : x > y;
+}
+
+// Bars of equal width buckets between min and max, one character each
+internal String
+db_stats_number_histogram(Arena *arena, DB_Stats_Column *stats) {
+    const char levels[] = " .:-=+*#";
+    f64        bins[DB_STATS_HISTOGRAM_BINS] = {0};
+    f64        min = stats->values.min.number;
+    f64        width = (stats->values.max.number - min) / DB_STATS_HISTOGRAM_BINS;
+    for (u64 s = 0; s < stats->sample_count; s++) {
+        // Comparisons are false for NaN, those land in the first bucket
+        f64 at = width > 0 ? (stats->samples[s].number - min) / width : 0;
+        u64 bin = at > 0 ? (at < DB_STATS_HISTOGRAM_BINS ? (u64)at : DB_STATS_HISTOGRAM_BINS - 1) : 0;
+        bins[bin] += stats->samples[s].weight;
+    }
+
+    f64 top = 0;
+    for (u64 b = 0; b < DB_STATS_HISTOGRAM_BINS; b++) {
+        top = Max(top, bins[b]);
+    }
+    u8 *bars = push_array(arena, u8, DB_STATS_HISTOGRAM_BINS);
+    for (u64 b = 0; b < DB_STATS_HISTOGRAM_BINS; b++) {
+        // A bucket with anything in it shows at least the lowest bar
+        bars[b] = bins[b] > 0 ? levels[1 + (u64)(bins[b] / top * (ArrayCount(levels) - 2.001))] : levels[0];
+    }
+    return str(bars, DB_STATS_HISTOGRAM_BINS);
+}
+
+// The values seen more than once in the sample, most common first, with
+// their estimated share of the non-null values. Samples are sorted by hash.
+internal String
+db_stats_common_values(Arena *arena, DB_View *view, u64 column, DB_Stats_Column *stats) {
+    DB_Stats_Sample *common[DB_STATS_COMMON_VALUES] = {0};
+    f64              common_weight[DB_STATS_COMMON_VALUES] = {0};
+    u64              common_count = 0;
+    for (u64 s = 0; s < stats->sample_count;) {
+        u64 end = s + 1;
+        f64 weight = stats->samples[s].weight;
+        for (; end < stats->sample_count && stats->samples[end].hash == stats->samples[s].hash; end++) {
+            weight += stats->samples[end].weight;
+        }
+        // Insertion into the few kept so far, the lightest one drops out
+        if (end - s > 1 && (common_count < DB_STATS_COMMON_VALUES || weight > common_weight[common_count - 1])) {
+            u64 at = common_count < DB_STATS_COMMON_VALUES ? common_count++ : common_count - 1;
+            for (; at > 0 && common_weight[at - 1] < weight; at--) {
+                common[at] = common[at - 1];
+                common_weight[at] = common_weight[at - 1];
+            }
+            common[at] = &stats->samples[s];
+            common_weight[at] = weight;
+        }
+        s = end;
+    }
+    if (common_count == 0)
+        return str_lit("no repeated values in the sample");
+
+    DB_Column_Info *col = dyn_array_get(&view->table->columns, DB_Column_Info, column);
+    char            buf[256];
+    u64             size = 0;
+    for (u64 i = 0; i < common_count && size < sizeof(buf); i++) {
+        u64          row_in_page;
+        DB_Row_Page *page = db_view_page_of(view, common[i]->row, &row_in_page);
+        String       value = db_page_cell_format(arena, page, row_in_page, column, col->type);
+        size += snprintf(buf + size, sizeof(buf) - size, "%s%.*s %.0f%%", i ? ", " : "", (int)Min(value.size, 24),
+                         (char *)value.data, common_weight[i] / (f64)stats->values.count * 100.0);
+    }
+    return str_push_copy(arena, cstr_to_string(buf, (u32)Min(size, sizeof(buf) - 1)));
+}
+
+////////////////////////////////
+// Tasks
+
+internal THREAD_POOL_TASK_FUNC(db_stats_rows_task) {
+    DB_Stats_Task *task = (DB_Stats_Task *)raw_task;
+    DB_View       *view = task->view;
+    Rng1_u64       range = task->ranges[task_id];
+    u64            rng = 0x9E3779B97F4A7C15ull * (task_id + 1);
+
+    // A column at a time, so each pass reads one column's chunks
+    for (u64 c = 0; c < task->column_count; c++) {
+        DB_Column_Info  *col = dyn_array_get(&view->table->columns, DB_Column_Info, c);
+        DB_Stats_Column *stats = &task->partials[task_id * task->column_count + c];
+        stats->values.all_numbers = 1;
+        stats->samples = push_array(arena, DB_Stats_Sample, DB_STATS_SAMPLE_CAP);
+
+        for (u64 i = range.min; i < range.max; i++) {
+            u32          row = view->rows[i];
+            u64          row_in_page;
+            DB_Row_Page *page = db_view_page_of(view, row, &row_in_page);
+            if (db_page_cell_is_null(page, row_in_page, c)) {
+                stats->nulls++;
+                continue;
+            }
+
+            String v = db_page_cell(page, row_in_page, c);
+            u64    hash = XXH3_64bits(v.data, v.size);
+            db_stats_hll_add(stats->registers, hash);
+
+            DB_Aggregate_Extreme value = {0};
+            value.row = row;
+            value.is_number = db_aggregate_number(col->type, v, &value.number);
+            db_aggregate_add(view, c, &stats->values, value);
+
+            // Reservoir sampling, every value so far has the same chance of being kept
+            u64 at = stats->sample_count;
+            if (at < DB_STATS_SAMPLE_CAP) {
+                stats->sample_count++;
+            } else {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                at = rng % stats->values.count;
+            }
+            if (at < DB_STATS_SAMPLE_CAP) {
+                DB_Stats_Sample *sample = &stats->samples[at];
+                sample->hash = hash;
+                sample->number = value.number;
+                sample->weight = 0;
+                sample->row = row;
+            }
+        }
+    }
+}
+
+// Merges one column's partials and formats its histogram
+internal THREAD_POOL_TASK_FUNC(db_stats_merge_task) {
+    DB_Stats_Task   *task = (DB_Stats_Task *)raw_task;
+    DB_View         *view = task->view;
+    u64              c = task_id;
+    DB_Stats_Column *into = &task->merged[c];
+    into->values.all_numbers = 1;
+    into->samples = push_array(arena, DB_Stats_Sample, task->partial_count * DB_STATS_SAMPLE_CAP);
+
+    for (u64 t = 0; t < task->partial_count; t++) {
+        DB_Stats_Column *from = &task->partials[t * task->column_count + c];
+        into->nulls += from->nulls;
+        for (u64 r = 0; r < DB_STATS_HLL_REGISTERS; r++) {
+            into->registers[r] = Max(into->registers[r], from->registers[r]);
+        }
+        db_aggregate_merge(view, c, &into->values, &from->values);
+
+        // Each kept value stands for an equal share of its task's values
+        for (u64 s = 0; s < from->sample_count; s++) {
+            DB_Stats_Sample *sample = &into->samples[into->sample_count++];
+            *sample = from->samples[s];
+            sample->weight = (f64)from->values.count / (f64)from->sample_count;
+        }
+    }
+
+    // Equal values end up next to each other
+    qsort(into->samples, into->sample_count, sizeof(DB_Stats_Sample), db_stats_sample_compare);
+    if (into->sample_count == into->values.count) {
+        // Every value was kept, they can be counted instead of estimated
+        u64 distinct = into->sample_count > 0;
+        for (u64 s = 1; s < into->sample_count; s++) {
+            distinct += into->samples[s].hash != into->samples[s - 1].hash;
+        }
+        task->distinct[c] = (f64)distinct;
+    } else {
+        // The sketch can overshoot on few values, there can't be more distinct ones than values
+        task->distinct[c] = Min(db_stats_hll_estimate(into->registers), (f64)into->values.count);
+    }
+
+    if (!into->values.has_value) {
+        task->histograms[c] = str_zero();
+    } else if (into->values.all_numbers) {
+        task->histograms[c] = db_stats_number_histogram(arena, into);
+    } else {
+        task->histograms[c] = db_stats_common_values(arena, view, c, into);
+    }
+}
+
+////////////////////////////////
+// Output
+
+internal void
+db_stats_push_cell(DB_Table *out, u64 column, const char *fmt, ...) {
+    char    buf[64];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    db_table_push_cell(out, column, cstr_to_string(buf, strlen(buf)), 0);
+}
+
+internal void
+db_stats_push_extreme(Arena *arena, DB_Table *out, u64 out_column, DB_View *view, u64 column, DB_Stats_Column *stats, b32 is_max) {
+    if (!stats->values.has_value) {
+        db_table_push_cell(out, out_column, str_zero(), 1);
+        return;
+    }
+    DB_Column_Info *col = dyn_array_get(&view->table->columns, DB_Column_Info, column);
+    u64             row_in_page;
+    DB_Row_Page    *page = db_view_page_of(view, is_max ? stats->values.max.row : stats->values.min.row, &row_in_page);
+    db_table_push_cell(out, out_column, db_page_cell_format(arena, page, row_in_page, column, col->type), 0);
+}
+
+internal DB_Table *
+db_stats(Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_View *view) {
+    PROF_FUNCTION;
+    Scratch  scratch = tctx_scratch_begin(0, 0);
+    Scratch *worker_scratches = push_array(scratch.arena, Scratch, pool_arena->count);
+    for (u64 i = 0; i < pool_arena->count; i++) {
+        worker_scratches[i] = scratch_begin(pool_arena->arenas[i]);
+    }
+
+    DB_Stats_Task task = {0};
+    task.view = view;
+    task.column_count = view->table->column_count;
+
+    u64 row_task_count = Min((view->count + DB_STATS_ROWS_PER_TASK - 1) / DB_STATS_ROWS_PER_TASK, (u64)pool->worker_count * 4);
+    row_task_count = Max(row_task_count, 1);
+    task.ranges = thread_pool_divide_work(scratch.arena, view->count, (u32)row_task_count);
+    task.partials = push_array_zero(scratch.arena, DB_Stats_Column, Max(row_task_count * task.column_count, 1));
+    task.partial_count = row_task_count;
+    task.merged = push_array_zero(scratch.arena, DB_Stats_Column, Max(task.column_count, 1));
+    task.distinct = push_array_zero(scratch.arena, f64, Max(task.column_count, 1));
+    task.histograms = push_array_zero(scratch.arena, String, Max(task.column_count, 1));
+    if (task.column_count) {
+        thread_pool_for_parallel(pool, pool_arena, row_task_count, db_stats_rows_task, &task);
+        thread_pool_for_parallel(pool, pool_arena, task.column_count, db_stats_merge_task, &task);
+    }
+
+    DB_Table   *out = db_table_alloc(view->table->schema);
+    const char *names[] = {"column", "type", "nulls", "null %", "distinct (est.)", "min", "max", "histogram"};
+    for (u64 i = 0; i < ArrayCount(names); i++) {
+        db_aggregate_push_column(out, cstr_to_string(names[i], strlen(names[i])));
+    }
+
+    for (u64 c = 0; c < task.column_count; c++) {
+        DB_Column_Info  *col = dyn_array_get(&view->table->columns, DB_Column_Info, c);
+        DB_Stats_Column *stats = &task.merged[c];
+
+        db_table_push_row(out);
+        db_table_push_cell(out, 0, col->column_name, 0);
+        db_table_push_cell(out, 1, col->data_type, col->data_type.size == 0);
+        db_stats_push_cell(out, 2, "%llu", (unsigned long long)stats->nulls);
+        db_stats_push_cell(out, 3, "%.1f", view->count ? (f64)stats->nulls / (f64)view->count * 100.0 : 0.0);
+        db_stats_push_cell(out, 4, "%.0f", task.distinct[c]);
+        db_stats_push_extreme(scratch.arena, out, 5, view, c, stats, 0);
+        db_stats_push_extreme(scratch.arena, out, 6, view, c, stats, 1);
+        db_table_push_cell(out, 7, task.histograms[c], task.histograms[c].size == 0);
+    }
+    db_table_publish_rows(out, task.column_count);
+
+    for (u64 i = 0; i < pool_arena->count; i++) {
+        scratch_end(&worker_scratches[i]);
+    }
+    tctx_scratch_end(scratch);
+    Prof_End();
+    return out;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "dbui.h"
+#include "db_view.h"
+
+// Profile of every column over the rows of a DB_View: nulls, an estimate of
+// the distinct values, min/max and a histogram. The result is a DB_Table with
+// one row per column, browsed like any fetched table.
+//
+// Everything comes out of one pass on the pool, each task walking its rows a
+// column at a time. Distinct values are estimated with a HyperLogLog sketch
+// of DB_STATS_HLL_REGISTERS registers per column and task, about 1.6% standard
+// error, merged by keeping the larger register. Histograms are built from
+// reservoir samples kept in the same pass: equal width buckets between min
+// and max for numbers, the most common values for anything else.
+
+#define DB_STATS_HLL_BITS        12
+#define DB_STATS_HLL_REGISTERS   (1 << DB_STATS_HLL_BITS)
+#define DB_STATS_SAMPLE_CAP      256 // Per task and column
+#define DB_STATS_HISTOGRAM_BINS  16
+#define DB_STATS_COMMON_VALUES   3
+
+internal DB_Table *db_stats(Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_View *view);
@@ -0,0 +1,335 @@
+#include "dbui.h"
+
+internal DB_Table *
+db_table_alloc(DB_Schema schema) {
+    Arena    *arena = arena_alloc();
+    DB_Table *table = push_struct_zero(arena, DB_Table);
+    table->arena = arena;
+    table->schema = schema;
+    // The request's copies are reused once it's posted, the table keeps its own
+    table->schema.schema = str_push_copy(arena, schema.schema);
+    table->schema.name = str_push_copy(arena, schema.name);
+    return table;
+}
+
+// Schema and table name as one hash key. The NUL keeps "a.b" + "c" apart
+// from "a" + "b.c", since dots may be part of either name.
+internal String
+db_schema_key(Arena *arena, String schema, String name) {
+    String key = {0};
+    key.size = schema.size + 1 + name.size;
+    key.data = push_array(arena, u8, key.size);
+    MemoryCopy(key.data, schema.data, schema.size);
+    key.data[schema.size] = 0;
+    MemoryCopy(key.data + schema.size + 1, name.data, name.size);
+    return key;
+}
+
+// Writer side: db_table_push_row, then one db_table_push_cell per column in
+// order. Only the thread filling the table calls these, and the columns have
+// to be known before the first row.
+internal void
+db_table_push_row(DB_Table *table) {
+    DB_Row_Page *page = table->last_page;
+    if (!page || page->count == DB_ROW_PAGE_CAP) {
+        page = push_struct_zero(table->arena, DB_Row_Page);
+        page->columns = push_array_zero(table->arena, DB_Column_Chunk, Max(table->column_count, 1));
+        if (table->zero_copy) {
+            for (u64 c = 0; c < table->column_count; c++) {
+                page->columns[c].refs = push_array(table->arena, String, DB_ROW_PAGE_CAP);
+            }
+        }
+        for (u64 c = 0; c < table->column_count; c++) {
+            DB_Column_Info *col = dyn_array_get(&table->columns, DB_Column_Info, c);
+            if (col && col->is_truncated) {
+                page->columns[c].full_sizes = push_array_zero(table->arena, u64, DB_ROW_PAGE_CAP);
+            }
+        }
+        if (table->projection.wide_count) {
+            page->locators = push_array_zero(table->arena, String, DB_ROW_PAGE_CAP);
+        }
+        if (table->last_page) {
+            table->last_page->next = page;
+        } else {
+            table->first_page = page;
+        }
+        table->last_page = page;
+    }
+    page->count++;
+}
+
+internal void
+db_table_push_cell(DB_Table *table, u64 column, String value, b32 is_null) {
+    DB_Row_Page     *page = table->last_page;
+    DB_Column_Chunk *chunk = &page->columns[column];
+    u64              row = page->count - 1;
+
+    if (is_null) {
+        chunk->nulls[row / 64] |= (1ull << (row % 64));
+        value.size = 0;
+    }
+
+    if (chunk->data_size + value.size > chunk->data_cap) {
+        // Readers may still hold the old blob, it stays valid since the arena never frees
+        u64 new_cap = Max(chunk->data_cap * 2, KB(1));
+        while (new_cap < chunk->data_size + value.size) {
+            new_cap *= 2;
+        }
+        u8 *data = push_array(table->arena, u8, new_cap);
+        if (chunk->data_size) {
+            MemoryCopy(data, chunk->data, chunk->data_size);
+        }
+        (void)ins_atomic_ptr_eval_assign(&chunk->data, data);
+        chunk->data_cap = new_cap;
+    }
+    if (value.size) {
+        MemoryCopy(chunk->data + chunk->data_size, value.data, value.size);
+    }
+    chunk->data_size += value.size;
+    chunk->offsets[row + 1] = (u32)chunk->data_size;
+    if (chunk->refs) {
+        chunk->refs[row] = str(chunk->data + chunk->data_size - value.size, value.size);
+    }
+}
+
+// Zero copy tables only: stores value without copying it. The memory has to
+// live as long as the table, usually a result handed to db_table_retain.
+internal void
+db_table_push_cell_ref(DB_Table *table, u64 column, String value, b32 is_null) {
+    DB_Row_Page     *page = table->last_page;
+    DB_Column_Chunk *chunk = &page->columns[column];
+    u64              row = page->count - 1;
+
+    ASSERT(chunk->refs, "Table is not zero copy");
+    if (is_null) {
+        chunk->nulls[row / 64] |= (1ull << (row % 64));
+        value.size = 0;
+    }
+    chunk->refs[row] = value;
+}
+
+// Whole size of the last row's value in a truncated column, 0 if nothing was cut
+internal void
+db_table_set_full_size(DB_Table *table, u64 column, u64 size) {
+    DB_Row_Page     *page = table->last_page;
+    DB_Column_Chunk *chunk = &page->columns[column];
+    if (chunk->full_sizes) {
+        chunk->full_sizes[page->count - 1] = size;
+    }
+}
+
+// Where the last row lives, copied into the table
+internal void
+db_table_set_locator(DB_Table *table, String locator) {
+    DB_Row_Page *page = table->last_page;
+    if (page->locators) {
+        page->locators[page->count - 1] = str_push_copy(table->arena, locator);
+    }
+}
+
+// Keeps a driver result alive until the table is freed
+internal void
+db_table_retain(DB_Table *table, DB_Kind kind, DB_Handle handle) {
+    DB_Retained_Result *retained = push_struct_zero(table->arena, DB_Retained_Result);
+    retained->kind = kind;
+    retained->handle = handle;
+    SLLStackPush_N(table->first_retained, retained, next);
+}
+
+// Makes the first row_count rows visible to readers, rows must be fully written before this
+internal void
+db_table_publish_rows(DB_Table *table, u64 row_count) {
+    ins_atomic_u64_eval_assign(&table->row_count, row_count);
+}
+
+internal u64
+db_table_row_count(DB_Table *table) {
+    return table ? ins_atomic_u64_eval(&table->row_count) : 0;
+}
+
+// Page holding row, only call with row < db_table_row_count
+internal DB_Row_Page *
+db_table_page(DB_Table *table, u64 row) {
+    DB_Row_Page *page = table->first_page;
+    for (u64 i = row / DB_ROW_PAGE_CAP; i > 0 && page; i--) {
+        page = page->next;
+    }
+    return page;
+}
+
+// Points into the page, valid as long as the table is
+internal String
+db_page_cell(DB_Row_Page *page, u64 row_in_page, u64 column) {
+    DB_Column_Chunk *chunk = &page->columns[column];
+    if (chunk->refs) {
+        return chunk->refs[row_in_page];
+    }
+    u8              *data = (u8 *)ins_atomic_ptr_eval(&chunk->data);
+    u32              begin = chunk->offsets[row_in_page];
+    u32              end = chunk->offsets[row_in_page + 1];
+    return str(data + begin, end - begin);
+}
+
+internal b32
+db_page_cell_is_null(DB_Row_Page *page, u64 row_in_page, u64 column) {
+    DB_Column_Chunk *chunk = &page->columns[column];
+    return (chunk->nulls[row_in_page / 64] >> (row_in_page % 64)) & 1;
+}
+
+// Bytes of the whole value if the cell only holds a prefix of it, else 0
+internal u64
+db_page_cell_full_size(DB_Row_Page *page, u64 row_in_page, u64 column) {
+    DB_Column_Chunk *chunk = &page->columns[column];
+    return chunk->full_sizes ? chunk->full_sizes[row_in_page] : 0;
+}
+
+// Bytes per value for fixed width column types, 0 for blobs
+internal u32
+db_column_type_size(DB_Column_Type type) {
+    switch (type) {
+    case DB_COLUMN_BOOL:
+        return 1;
+    case DB_COLUMN_INT16:
+        return 2;
+    case DB_COLUMN_INT32:
+    case DB_COLUMN_FLOAT32:
+    case DB_COLUMN_DATE:
+        return 4;
+    case DB_COLUMN_INT64:
+    case DB_COLUMN_FLOAT64:
+    case DB_COLUMN_NUMERIC:
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ:
+        return 8;
+    case DB_COLUMN_UUID:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+// Days since 1970-01-01 to a civil date (Howard Hinnant's days_from_civil inverse)
+internal void
+db_civil_from_days(s64 days, s32 *year, u32 *month, u32 *day) {
+    days += 719468;
+    s64 era = (days >= 0 ? days : days - 146096) / 146097;
+    u32 doe = (u32)(days - era * 146097);
+    u32 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    u32 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    u32 mp = (5 * doy + 2) / 153;
+    *day = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = (s32)(yoe + era * 400 + (*month <= 2));
+}
+
+// Text for one cell. Typed values are only formatted here, for the cells that
+// are actually shown. Blobs are returned without copying.
+internal String
+db_page_cell_format(Arena *arena, DB_Row_Page *page, u64 row_in_page, u64 column, DB_Column_Type type) {
+    if (db_page_cell_is_null(page, row_in_page, column)) {
+        return str_lit("NULL");
+    }
+
+    String value = db_page_cell(page, row_in_page, column);
+    if (type == DB_COLUMN_TEXT) {
+        return value;
+    }
+    if (value.size < db_column_type_size(type)) {
+        type = DB_COLUMN_BYTES;
+    }
+
+    // Postgres epoch (2000-01-01) in days since the unix epoch
+    s64  pg_epoch_days = 10957;
+    char buf[64];
+    s32  len = 0;
+    u8  *v = value.data;
+    switch (type) {
+    case DB_COLUMN_BOOL: {
+        return v[0] ? str_lit("true") : str_lit("false");
+    } break;
+    case DB_COLUMN_INT16: {
+        s16 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%d", (int)x);
+    } break;
+    case DB_COLUMN_INT32: {
+        s32 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%d", x);
+    } break;
+    case DB_COLUMN_INT64: {
+        s64 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%lld", (long long)x);
+    } break;
+    case DB_COLUMN_FLOAT32: {
+        f32 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%g", (double)x);
+    } break;
+    case DB_COLUMN_FLOAT64: {
+        f64 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%.15g", x);
+    } break;
+    case DB_COLUMN_NUMERIC: {
+        // The exact text follows the f64 key, cells without it only have the key
+        if (value.size > 8) {
+            return str(v + 8, value.size - 8);
+        }
+        f64 x;
+        MemoryCopy(&x, v, sizeof(x));
+        len = snprintf(buf, sizeof(buf), "%.15g", x);
+    } break;
+    case DB_COLUMN_DATE: {
+        s32 days;
+        s32 year;
+        u32 month, day;
+        MemoryCopy(&days, v, sizeof(days));
+        db_civil_from_days(pg_epoch_days + days, &year, &month, &day);
+        len = snprintf(buf, sizeof(buf), "%04d-%02u-%02u", year, month, day);
+    } break;
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ: {
+        s64 micros;
+        MemoryCopy(&micros, v, sizeof(micros));
+        s64 usec_per_day = 86400ll * 1000000ll;
+        s64 days = micros / usec_per_day;
+        s64 rem = micros % usec_per_day;
+        if (rem < 0) {
+            rem += usec_per_day;
+            days -= 1;
+        }
+        s32 year;
+        u32 month, day;
+        db_civil_from_days(pg_epoch_days + days, &year, &month, &day);
+        s64 secs = rem / 1000000;
+        len = snprintf(buf, sizeof(buf), "%04d-%02u-%02u %02d:%02d:%02d.%06d%s", year, month, day,
+                       (int)(secs / 3600), (int)(secs / 60 % 60), (int)(secs % 60), (int)(rem % 1000000),
+                       type == DB_COLUMN_TIMESTAMPTZ ? "+00" : "");
+    } break;
+    case DB_COLUMN_UUID: {
+        for (u32 i = 0; i < 16; i++) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) {
+                buf[len++] = '-';
+            }
+            len += snprintf(buf + len, sizeof(buf) - len, "%02x", v[i]);
+        }
+    } break;
+    case DB_COLUMN_BYTES: {
+        // Hex like bytea's text output, capped since this is only for display
+        u32  count = Min(value.size, 29);
+        char hex[] = "0123456789abcdef";
+        buf[len++] = '\\';
+        buf[len++] = 'x';
+        for (u32 i = 0; i < count; i++) {
+            buf[len++] = hex[v[i] >> 4];
+            buf[len++] = hex[v[i] & 15];
+        }
+    } break;
+    default:
+        return value;
+    }
+
+    return str_push_copy(arena, str((u8 *)buf, (u32)Max(len, 0)));
+}
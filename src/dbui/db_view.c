@@ -0,0 +1,925 @@
+#include "db_view.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define DB_VIEW_SSE2 1
+#else
+#    define DB_VIEW_SSE2 0
+#endif
+
+#define DB_VIEW_MASK_WORDS (DB_ROW_PAGE_CAP / 64)
+
+// A filter with its constant converted to the column's storage, once per build
+typedef struct DB_Filter_Compiled DB_Filter_Compiled;
+struct DB_Filter_Compiled {
+    DB_Filter_Op   op;
+    u64            column;
+    DB_Column_Type type;
+    String         text;
+    b32            is_number; // TEXT: the constant is a number, cells that are numbers compare as numbers
+    s64            integer;   // BOOL, INT*, DATE, TIMESTAMP*
+    f64            number;    // FLOAT*, NUMERIC, numeric text
+    u8             uuid[16];
+};
+
+////////////////////////////////
+// Constants
+
+internal b32
+db_view_parse_f64(String s, f64 *out) {
+    char buf[64];
+    // Cheap reject first, most text isn't a number
+    if (s.size == 0 || s.size >= sizeof(buf) || !((s.data[0] >= '0' && s.data[0] <= '9') || s.data[0] == '-' || s.data[0] == '+' || s.data[0] == '.'))
+        return 0;
+    MemoryCopy(buf, s.data, s.size);
+    buf[s.size] = 0;
+    char *end = 0;
+    *out = strtod(buf, &end);
+    return end == buf + s.size;
+}
+
+internal b32
+db_view_parse_s64(String s, s64 *out) {
+    char buf[32];
+    if (s.size == 0 || s.size >= sizeof(buf))
+        return 0;
+    MemoryCopy(buf, s.data, s.size);
+    buf[s.size] = 0;
+    char *end = 0;
+    errno = 0;
+    *out = strtoll(buf, &end, 10);
+    return end == buf + s.size && errno == 0;
+}
+
+// Inverse of db_civil_from_days
+internal s64
+db_view_days_from_civil(s64 year, u32 month, u32 day) {
+    year -= month <= 2;
+    s64 era = (year >= 0 ? year : year - 399) / 400;
+    u32 yoe = (u32)(year - era * 400);
+    u32 doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    u32 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (s64)doe - 719468;
+}
+
+// YYYY-MM-DD[( |T)HH:MM[:SS[.ffffff]]] to microseconds since 2000-01-01, days in out_days
+internal b32
+db_view_parse_timestamp(String s, s64 *out_days, s64 *out_micros) {
+    u32 year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, micros = 0;
+    char buf[64];
+    if (s.size < 10 || s.size >= sizeof(buf))
+        return 0;
+    MemoryCopy(buf, s.data, s.size);
+    buf[s.size] = 0;
+    if (sscanf(buf, "%4u-%2u-%2u", &year, &month, &day) != 3 || month < 1 || month > 12 || day < 1 || day > 31)
+        return 0;
+    if (s.size > 10) {
+        char frac[8] = {0};
+        s32  fields = sscanf(buf + 11, "%2u:%2u:%2u.%6[0-9]", &hour, &minute, &second, frac);
+        if (fields < 2)
+            return 0;
+        for (u32 i = 0; i < 6; i++) {
+            micros = micros * 10 + (frac[i] ? (u32)(frac[i] - '0') : 0);
+            if (!frac[i]) {
+                for (u32 j = i + 1; j < 6; j++) {
+                    micros *= 10;
+                }
+                break;
+            }
+        }
+    }
+    s64 days = db_view_days_from_civil(year, month, day) - 10957; // Postgres epoch
+    *out_days = days;
+    *out_micros = ((days * 86400 + hour * 3600 + minute * 60 + second) * 1000000ll) + micros;
+    return 1;
+}
+
+internal b32
+db_view_parse_uuid(String s, u8 *out) {
+    u32 nibbles = 0;
+    for (u64 i = 0; i < s.size; i++) {
+        u8 ch = s.data[i];
+        u8 v = ch >= '0' && ch <= '9' ? ch - '0' : ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 : ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : 0xFF;
+        if (ch == '-')
+            continue;
+        if (v == 0xFF || nibbles == 32)
+            return 0;
+        out[nibbles / 2] = (nibbles & 1) ? (u8)(out[nibbles / 2] | v) : (u8)(v << 4);
+        nibbles++;
+    }
+    return nibbles == 32;
+}
+
+internal b32
+db_view_compile_filter(DB_Table *table, DB_Filter *filter, DB_Filter_Compiled *out) {
+    DB_Column_Info *col = dyn_array_get(&table->columns, DB_Column_Info, filter->column);
+    MemoryZeroStruct(out);
+    out->op = filter->op;
+    out->column = filter->column;
+    out->type = col->type;
+    out->text = filter->value;
+    if (filter->op == DB_FILTER_IS_NULL || filter->op == DB_FILTER_IS_NOT_NULL || filter->op == DB_FILTER_LIKE)
+        return 1;
+
+    String v = filter->value;
+    s64    days = 0;
+    switch (col->type) {
+    case DB_COLUMN_TEXT:
+    case DB_COLUMN_BYTES: {
+        out->is_number = db_view_parse_f64(v, &out->number);
+        return 1;
+    } break;
+    case DB_COLUMN_BOOL: {
+        b32 is_true = str_match(v, str_lit("true")) || str_match(v, str_lit("t")) || str_match(v, str_lit("1"));
+        b32 is_false = str_match(v, str_lit("false")) || str_match(v, str_lit("f")) || str_match(v, str_lit("0"));
+        out->integer = is_true;
+        return is_true || is_false;
+    } break;
+    case DB_COLUMN_INT16:
+    case DB_COLUMN_INT32:
+    case DB_COLUMN_INT64: {
+        return db_view_parse_s64(v, &out->integer);
+    } break;
+    case DB_COLUMN_FLOAT32:
+    case DB_COLUMN_FLOAT64:
+    case DB_COLUMN_NUMERIC: {
+        return db_view_parse_f64(v, &out->number);
+    } break;
+    case DB_COLUMN_DATE: {
+        s64 micros;
+        b32 ok = db_view_parse_timestamp(v, &days, &micros);
+        out->integer = days;
+        return ok;
+    } break;
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ: {
+        return db_view_parse_timestamp(v, &days, &out->integer);
+    } break;
+    case DB_COLUMN_UUID: {
+        return (filter->op == DB_FILTER_EQ || filter->op == DB_FILTER_NE) && db_view_parse_uuid(v, out->uuid);
+    } break;
+    default:
+        return 0;
+    }
+}
+
+////////////////////////////////
+// Comparison kernels
+
+// Bits of the values an op keeps, given which ones are less than and equal to the constant
+internal inline u64
+db_view_op_bits(DB_Filter_Op op, u64 lt, u64 eq, u64 all) {
+    switch (op) {
+    case DB_FILTER_EQ:
+        return eq;
+    case DB_FILTER_NE:
+        return all & ~eq;
+    case DB_FILTER_LT:
+        return lt;
+    case DB_FILTER_LE:
+        return lt | eq;
+    case DB_FILTER_GT:
+        return all & ~(lt | eq);
+    case DB_FILTER_GE:
+        return all & ~lt;
+    default:
+        return 0;
+    }
+}
+
+// Scalar kernels over count packed values, bit i of out is value i. NaN is
+// neither less nor equal, so it counts as greater than everything like in Postgres.
+#define DB_VIEW_COMPARE_FUNC(name, T, K)                                        \
+    internal void name(u8 *values, u64 begin, u64 count, K k, DB_Filter_Op op, u64 *out) { \
+        for (u64 i = begin; i < count; i++) {                                   \
+            T v;                                                                \
+            MemoryCopy(&v, values + i * sizeof(T), sizeof(T));                  \
+            u64 bit = db_view_op_bits(op, (K)v < k, (K)v == k, 1);              \
+            out[i / 64] |= bit << (i % 64);                                     \
+        }                                                                       \
+    }
+
+DB_VIEW_COMPARE_FUNC(db_view_compare_u8_scalar, u8, s64)
+DB_VIEW_COMPARE_FUNC(db_view_compare_s16_scalar, s16, s64)
+DB_VIEW_COMPARE_FUNC(db_view_compare_s32_scalar, s32, s64)
+DB_VIEW_COMPARE_FUNC(db_view_compare_s64_scalar, s64, s64)
+DB_VIEW_COMPARE_FUNC(db_view_compare_f32_scalar, f32, f32)
+DB_VIEW_COMPARE_FUNC(db_view_compare_f64_scalar, f64, f64)
+
+internal void
+db_view_compare_s32(u8 *values, u64 count, s64 k, DB_Filter_Op op, u64 *out) {
+    u64 i = 0;
+#if DB_VIEW_SSE2
+    // Out of range constants stay on the s64 path
+    if (k >= -(s64)0x80000000ll && k <= (s64)0x7FFFFFFFll) {
+        __m128i kv = _mm_set1_epi32((s32)k);
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128((__m128i *)(values + i * 4));
+            u64     lt = (u64)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, kv)));
+            u64     eq = (u64)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, kv)));
+            out[i / 64] |= db_view_op_bits(op, lt, eq, 0xF) << (i % 64);
+        }
+    }
+#endif
+    db_view_compare_s32_scalar(values, i, count, k, op, out);
+}
+
+internal void
+db_view_compare_f32(u8 *values, u64 count, f32 k, DB_Filter_Op op, u64 *out) {
+    u64 i = 0;
+#if DB_VIEW_SSE2
+    __m128 kv = _mm_set1_ps(k);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps((f32 *)(values + i * 4));
+        u64    lt = (u64)_mm_movemask_ps(_mm_cmplt_ps(v, kv));
+        u64    eq = (u64)_mm_movemask_ps(_mm_cmpeq_ps(v, kv));
+        out[i / 64] |= db_view_op_bits(op, lt, eq, 0xF) << (i % 64);
+    }
+#endif
+    db_view_compare_f32_scalar(values, i, count, k, op, out);
+}
+
+internal void
+db_view_compare_f64(u8 *values, u64 count, f64 k, DB_Filter_Op op, u64 *out) {
+    u64 i = 0;
+#if DB_VIEW_SSE2
+    __m128d kv = _mm_set1_pd(k);
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_loadu_pd((f64 *)(values + i * 8));
+        u64     lt = (u64)_mm_movemask_pd(_mm_cmplt_pd(v, kv));
+        u64     eq = (u64)_mm_movemask_pd(_mm_cmpeq_pd(v, kv));
+        out[i / 64] |= db_view_op_bits(op, lt, eq, 0x3) << (i % 64);
+    }
+#endif
+    db_view_compare_f64_scalar(values, i, count, k, op, out);
+}
+
+internal u64
+db_view_popcount(u64 x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (x * 0x0101010101010101ull) >> 56;
+}
+
+// Typed column fast path over the packed non-null values. Returns 0 if the
+// chunk can't take it and the cells have to be checked one by one.
+internal b32
+db_view_filter_packed(DB_Row_Page *page, u64 row_count, DB_Filter_Compiled *f, u64 *bits) {
+    u32 size = db_column_type_size(f->type);
+    if (size == 0 || f->type == DB_COLUMN_UUID || f->op == DB_FILTER_LIKE)
+        return 0;
+
+    DB_Column_Chunk *chunk = &page->columns[f->column];
+    u64              null_count = 0;
+    if (chunk->refs)
+        return 0; // Zero copy cells may not have a decoded copy
+    for (u64 w = 0; w < DB_VIEW_MASK_WORDS; w++) {
+        null_count += db_view_popcount(chunk->nulls[w]);
+    }
+    u64 packed_count = row_count - null_count;
+    if (chunk->data_size < packed_count * size || chunk->offsets[row_count] != packed_count * size)
+        return 0; // A value kept its raw form
+
+    u8 *values = (u8 *)ins_atomic_ptr_eval(&chunk->data);
+    u64 packed[DB_VIEW_MASK_WORDS] = {0};
+    switch (f->type) {
+    case DB_COLUMN_BOOL:
+        db_view_compare_u8_scalar(values, 0, packed_count, f->integer, f->op, packed);
+        break;
+    case DB_COLUMN_INT16:
+        db_view_compare_s16_scalar(values, 0, packed_count, f->integer, f->op, packed);
+        break;
+    case DB_COLUMN_INT32:
+    case DB_COLUMN_DATE:
+        db_view_compare_s32(values, packed_count, f->integer, f->op, packed);
+        break;
+    case DB_COLUMN_INT64:
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ:
+        db_view_compare_s64_scalar(values, 0, packed_count, f->integer, f->op, packed);
+        break;
+    case DB_COLUMN_FLOAT32:
+        db_view_compare_f32(values, packed_count, (f32)f->number, f->op, packed);
+        break;
+    case DB_COLUMN_FLOAT64:
+    case DB_COLUMN_NUMERIC:
+        db_view_compare_f64(values, packed_count, f->number, f->op, packed);
+        break;
+    default:
+        return 0;
+    }
+
+    if (null_count == 0) {
+        MemoryCopy(bits, packed, sizeof(packed));
+        return 1;
+    }
+    // Spread the packed bits over the rows, nulls never match a comparison
+    u64 p = 0;
+    for (u64 r = 0; r < row_count; r++) {
+        if ((chunk->nulls[r / 64] >> (r % 64)) & 1)
+            continue;
+        bits[r / 64] |= ((packed[p / 64] >> (p % 64)) & 1) << (r % 64);
+        p++;
+    }
+    return 1;
+}
+
+////////////////////////////////
+// Cells
+
+internal s32
+db_view_compare_text(String a, String b) {
+    s32 cmp = memcmp(a.data, b.data, Min(a.size, b.size));
+    if (cmp == 0) {
+        cmp = a.size < b.size ? -1 : a.size > b.size ? 1 : 0;
+    }
+    return cmp;
+}
+
+// SQL LIKE, % is any run of bytes and _ any one byte
+internal b32
+db_view_like(String s, String pattern) {
+    u64 si = 0, pi = 0;
+    u64 star = (u64)-1, star_s = 0;
+    while (si < s.size) {
+        if (pi < pattern.size && pattern.data[pi] == '%') {
+            star = pi++;
+            star_s = si;
+        } else if (pi < pattern.size && (pattern.data[pi] == '_' || pattern.data[pi] == s.data[si])) {
+            pi++;
+            si++;
+        } else if (star != (u64)-1) {
+            pi = star + 1;
+            si = ++star_s;
+        } else {
+            return 0;
+        }
+    }
+    while (pi < pattern.size && pattern.data[pi] == '%') {
+        pi++;
+    }
+    return pi == pattern.size;
+}
+
+// Typed value as a number for the comparison, 0 if the cell kept its raw form.
+// Numeric cells carry their exact text after the f64.
+internal b32
+db_view_cell_number(DB_Column_Type type, String v, s64 *out_integer, f64 *out_number) {
+    u32 size = db_column_type_size(type);
+    if (v.size != size && !(type == DB_COLUMN_NUMERIC && v.size > size))
+        return 0;
+    switch (type) {
+    case DB_COLUMN_BOOL:
+        *out_integer = v.data[0];
+        return 1;
+    case DB_COLUMN_INT16: {
+        s16 x;
+        MemoryCopy(&x, v.data, 2);
+        *out_integer = x;
+    } return 1;
+    case DB_COLUMN_INT32:
+    case DB_COLUMN_DATE: {
+        s32 x;
+        MemoryCopy(&x, v.data, 4);
+        *out_integer = x;
+    } return 1;
+    case DB_COLUMN_INT64:
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ:
+        MemoryCopy(out_integer, v.data, 8);
+        return 1;
+    case DB_COLUMN_FLOAT32: {
+        f32 x;
+        MemoryCopy(&x, v.data, 4);
+        *out_number = x;
+    } return 1;
+    case DB_COLUMN_FLOAT64:
+    case DB_COLUMN_NUMERIC:
+        MemoryCopy(out_number, v.data, 8);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+internal b32
+db_view_match_cell(Arena *arena, DB_Row_Page *page, u64 row, DB_Filter_Compiled *f) {
+    String v = db_page_cell(page, row, f->column);
+    b32    is_text = f->type == DB_COLUMN_TEXT || f->type == DB_COLUMN_BYTES;
+    if (f->op == DB_FILTER_LIKE) {
+        return db_view_like(is_text ? v : db_page_cell_format(arena, page, row, f->column, f->type), f->text);
+    }
+    if (f->type == DB_COLUMN_UUID) {
+        b32 eq = v.size == 16 && memcmp(v.data, f->uuid, 16) == 0;
+        return f->op == DB_FILTER_EQ ? eq : !eq;
+    }
+
+    s32 cmp = 0;
+    s64 integer = 0;
+    f64 number = 0;
+    if (is_text) {
+        if (f->is_number && db_view_parse_f64(v, &number)) {
+            cmp = number < f->number ? -1 : number > f->number ? 1 : 0;
+        } else {
+            cmp = db_view_compare_text(v, f->text);
+        }
+    } else if (!db_view_cell_number(f->type, v, &integer, &number)) {
+        return 0;
+    } else if (f->type == DB_COLUMN_FLOAT32 || f->type == DB_COLUMN_FLOAT64 || f->type == DB_COLUMN_NUMERIC) {
+        cmp = number < f->number ? -1 : number == f->number ? 0 : 1;
+    } else {
+        cmp = integer < f->integer ? -1 : integer > f->integer ? 1 : 0;
+    }
+    return (b32)db_view_op_bits(f->op, cmp < 0, cmp == 0, 1);
+}
+
+////////////////////////////////
+// Filter
+
+typedef struct DB_View_Filter_Task DB_View_Filter_Task;
+struct DB_View_Filter_Task {
+    DB_View            *view;
+    DB_Filter_Compiled *filters;
+    u64                 filter_count;
+    Rng1_u64           *ranges;       // Pages per task
+    u32                *page_matches; // Matching rows per page, stored at rows + page * DB_ROW_PAGE_CAP
+};
+
+internal THREAD_POOL_TASK_FUNC(db_view_filter_task) {
+    DB_View_Filter_Task *task = (DB_View_Filter_Task *)raw_task;
+    DB_View             *view = task->view;
+    u64                  table_rows = db_table_row_count(view->table);
+
+    for (u64 p = task->ranges[task_id].min; p < task->ranges[task_id].max; p++) {
+        DB_Row_Page *page = view->pages[p];
+        u64          row_count = Min(page->count, table_rows - p * DB_ROW_PAGE_CAP);
+        u64          mask[DB_VIEW_MASK_WORDS] = {0};
+        for (u64 r = 0; r < row_count; r++) {
+            mask[r / 64] |= 1ull << (r % 64);
+        }
+
+        Scratch scratch = scratch_begin(arena);
+        for (u64 i = 0; i < task->filter_count; i++) {
+            DB_Filter_Compiled *f = &task->filters[i];
+            DB_Column_Chunk    *chunk = &page->columns[f->column];
+            u64                 bits[DB_VIEW_MASK_WORDS] = {0};
+            if (f->op == DB_FILTER_IS_NULL || f->op == DB_FILTER_IS_NOT_NULL) {
+                for (u64 w = 0; w < DB_VIEW_MASK_WORDS; w++) {
+                    bits[w] = f->op == DB_FILTER_IS_NULL ? chunk->nulls[w] : ~chunk->nulls[w];
+                }
+            } else if (!db_view_filter_packed(page, row_count, f, bits)) {
+                for (u64 r = 0; r < row_count; r++) {
+                    if (((mask[r / 64] >> (r % 64)) & 1) && !db_page_cell_is_null(page, r, f->column) &&
+                        db_view_match_cell(scratch.arena, page, r, f)) {
+                        bits[r / 64] |= 1ull << (r % 64);
+                    }
+                }
+            }
+            u64 any = 0;
+            for (u64 w = 0; w < DB_VIEW_MASK_WORDS; w++) {
+                mask[w] &= bits[w];
+                any |= mask[w];
+            }
+            if (!any)
+                break;
+        }
+        scratch_end(&scratch);
+
+        u32 *out = view->rows + p * DB_ROW_PAGE_CAP;
+        u32  count = 0;
+        for (u64 w = 0; w < DB_VIEW_MASK_WORDS; w++) {
+            for (u64 word = mask[w]; word; word &= word - 1) {
+                out[count++] = (u32)(p * DB_ROW_PAGE_CAP + w * 64 + db_view_popcount((word & (0 - word)) - 1));
+            }
+        }
+        task->page_matches[p] = count;
+    }
+}
+
+////////////////////////////////
+// Sort
+
+internal DB_Row_Page *
+db_view_page_of(DB_View *view, u32 row, u64 *out_row_in_page) {
+    *out_row_in_page = row % DB_ROW_PAGE_CAP;
+    return view->pages[row / DB_ROW_PAGE_CAP];
+}
+
+// Order preserving unsigned keys: flip the sign bit of integers, and for
+// floats all bits of negatives, the sign bit of the rest
+internal u64
+db_view_key_from_s64(s64 x) {
+    return (u64)x ^ (1ull << 63);
+}
+
+internal u64
+db_view_key_from_f64(f64 x) {
+    u64 bits;
+    MemoryCopy(&bits, &x, 8);
+    return (bits >> 63) ? ~bits : bits | (1ull << 63);
+}
+
+// Radix sort keys for the non-null rows of a column, 0 if the column needs the text sort
+internal b32
+db_view_sort_keys(DB_View *view, u64 column, u32 *rows, u64 count, u64 *keys) {
+    DB_Column_Info *col = dyn_array_get(&view->table->columns, DB_Column_Info, column);
+    b32             is_text = col->type == DB_COLUMN_TEXT || col->type == DB_COLUMN_BYTES;
+    if (col->type == DB_COLUMN_UUID)
+        return 0;
+
+    for (u64 i = 0; i < count; i++) {
+        u64          row_in_page;
+        DB_Row_Page *page = db_view_page_of(view, rows[i], &row_in_page);
+        String       v = db_page_cell(page, row_in_page, column);
+        s64          integer = 0;
+        f64          number = 0;
+        if (is_text) {
+            if (!db_view_parse_f64(v, &number))
+                return 0;
+            keys[i] = db_view_key_from_f64(number);
+        } else if (!db_view_cell_number(col->type, v, &integer, &number)) {
+            return 0;
+        } else if (col->type == DB_COLUMN_FLOAT32 || col->type == DB_COLUMN_FLOAT64 || col->type == DB_COLUMN_NUMERIC) {
+            keys[i] = db_view_key_from_f64(number);
+        } else {
+            keys[i] = db_view_key_from_s64(integer);
+        }
+    }
+    return 1;
+}
+
+// Stable LSD radix sort, a byte per pass. Passes where every key has the same byte are skipped.
+internal void
+db_view_radix_sort(u64 *keys, u32 *rows, u64 count, u64 *keys_tmp, u32 *rows_tmp) {
+    u32 counts[8][256];
+    MemoryZero(counts, sizeof(counts));
+    for (u64 i = 0; i < count; i++) {
+        for (u32 b = 0; b < 8; b++) {
+            counts[b][(keys[i] >> (b * 8)) & 0xFF]++;
+        }
+    }
+
+    u64 *src_keys = keys, *dst_keys = keys_tmp;
+    u32 *src_rows = rows, *dst_rows = rows_tmp;
+    for (u32 b = 0; b < 8; b++) {
+        if (count == 0 || counts[b][(keys[0] >> (b * 8)) & 0xFF] == count)
+            continue;
+        u32 offsets[256];
+        u32 sum = 0;
+        for (u32 d = 0; d < 256; d++) {
+            offsets[d] = sum;
+            sum += counts[b][d];
+        }
+        for (u64 i = 0; i < count; i++) {
+            u32 at = offsets[(src_keys[i] >> (b * 8)) & 0xFF]++;
+            dst_keys[at] = src_keys[i];
+            dst_rows[at] = src_rows[i];
+        }
+        u64 *keys_swap = src_keys;
+        u32 *rows_swap = src_rows;
+        src_keys = dst_keys;
+        dst_keys = keys_swap;
+        src_rows = dst_rows;
+        dst_rows = rows_swap;
+    }
+    if (src_rows != rows) {
+        MemoryCopy(rows, src_rows, sizeof(u32) * count);
+    }
+}
+
+typedef struct DB_View_Text_Key DB_View_Text_Key;
+struct DB_View_Text_Key {
+    String value;
+    u32    row;
+};
+
+// Stable bottom-up merge sort by bytes
+internal void
+db_view_merge_sort(DB_View_Text_Key *items, DB_View_Text_Key *tmp, u64 count, b32 descending) {
+    DB_View_Text_Key *src = items, *dst = tmp;
+    for (u64 width = 1; width < count; width *= 2) {
+        for (u64 lo = 0; lo < count; lo += width * 2) {
+            u64 mid = Min(lo + width, count);
+            u64 hi = Min(lo + width * 2, count);
+            u64 a = lo, b = mid, out = lo;
+            while (a < mid && b < hi) {
+                s32 cmp = db_view_compare_text(src[a].value, src[b].value);
+                // Ties take the left side, that's what keeps it stable
+                b32 take_right = descending ? cmp < 0 : cmp > 0;
+                dst[out++] = take_right ? src[b++] : src[a++];
+            }
+            while (a < mid) {
+                dst[out++] = src[a++];
+            }
+            while (b < hi) {
+                dst[out++] = src[b++];
+            }
+        }
+        DB_View_Text_Key *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != items) {
+        MemoryCopy(items, src, sizeof(DB_View_Text_Key) * count);
+    }
+}
+
+internal void
+db_view_sort_by(Arena *arena, DB_View *view, DB_Sort_Key key) {
+    Scratch scratch = scratch_begin(arena);
+    u64     count = view->count;
+    u32    *values = push_array(scratch.arena, u32, Max(count, 1));
+    u32    *nulls = push_array(scratch.arena, u32, Max(count, 1));
+    u64     value_count = 0;
+    u64     null_count = 0;
+    for (u64 i = 0; i < count; i++) {
+        u64          row_in_page;
+        DB_Row_Page *page = db_view_page_of(view, view->rows[i], &row_in_page);
+        if (db_page_cell_is_null(page, row_in_page, key.column)) {
+            nulls[null_count++] = view->rows[i];
+        } else {
+            values[value_count++] = view->rows[i];
+        }
+    }
+
+    u64 *keys = push_array(scratch.arena, u64, Max(value_count, 1));
+    if (db_view_sort_keys(view, key.column, values, value_count, keys)) {
+        if (key.descending) {
+            for (u64 i = 0; i < value_count; i++) {
+                keys[i] = ~keys[i];
+            }
+        }
+        u64 *keys_tmp = push_array(scratch.arena, u64, Max(value_count, 1));
+        u32 *rows_tmp = push_array(scratch.arena, u32, Max(value_count, 1));
+        db_view_radix_sort(keys, values, value_count, keys_tmp, rows_tmp);
+    } else {
+        DB_View_Text_Key *items = push_array(scratch.arena, DB_View_Text_Key, Max(value_count, 1));
+        DB_View_Text_Key *tmp = push_array(scratch.arena, DB_View_Text_Key, Max(value_count, 1));
+        for (u64 i = 0; i < value_count; i++) {
+            u64          row_in_page;
+            DB_Row_Page *page = db_view_page_of(view, values[i], &row_in_page);
+            items[i].value = db_page_cell(page, row_in_page, key.column);
+            items[i].row = values[i];
+        }
+        db_view_merge_sort(items, tmp, value_count, key.descending);
+        for (u64 i = 0; i < value_count; i++) {
+            values[i] = items[i].row;
+        }
+    }
+
+    // Postgres puts nulls last ascending and first descending
+    u32 *first = key.descending ? nulls : values;
+    u64  first_count = key.descending ? null_count : value_count;
+    u32 *second = key.descending ? values : nulls;
+    u64  second_count = key.descending ? value_count : null_count;
+    MemoryCopy(view->rows, first, sizeof(u32) * first_count);
+    MemoryCopy(view->rows + first_count, second, sizeof(u32) * second_count);
+    scratch_end(&scratch);
+}
+
+////////////////////////////////
+// Parsing
+
+internal b32
+db_view_char_is_space(u8 ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+internal String
+db_view_trim(String s) {
+    while (s.size && db_view_char_is_space(s.data[0])) {
+        s.data++;
+        s.size--;
+    }
+    while (s.size && db_view_char_is_space(s.data[s.size - 1])) {
+        s.size--;
+    }
+    return s;
+}
+
+internal b32
+db_view_match_nocase(String a, String b) {
+    if (a.size != b.size)
+        return 0;
+    for (u64 i = 0; i < a.size; i++) {
+        u8 x = a.data[i] >= 'A' && a.data[i] <= 'Z' ? a.data[i] + 32 : a.data[i];
+        u8 y = b.data[i] >= 'A' && b.data[i] <= 'Z' ? b.data[i] + 32 : b.data[i];
+        if (x != y)
+            return 0;
+    }
+    return 1;
+}
+
+// Word at the start of s, case-insensitive, followed by a space or the end
+internal b32
+db_view_starts_with_word(String s, String word) {
+    return s.size >= word.size && db_view_match_nocase(str(s.data, word.size), word) &&
+           (s.size == word.size || db_view_char_is_space(s.data[word.size]));
+}
+
+// Name at the start of rest, in double quotes or up to a space or one of stops
+internal String
+db_view_take_name(String *rest, const char *stops) {
+    String name = {0};
+    u64    end = 0;
+    if (rest->size && rest->data[0] == '"') {
+        end = 1;
+        while (end < rest->size && rest->data[end] != '"') {
+            end++;
+        }
+        name = str(rest->data + 1, (u32)(end - 1));
+        end = Min(end + 1, rest->size);
+    } else {
+        while (end < rest->size && !db_view_char_is_space(rest->data[end]) && !strchr(stops, rest->data[end])) {
+            end++;
+        }
+        name = str(rest->data, (u32)end);
+    }
+    *rest = str(rest->data + end, (u32)(rest->size - end));
+    return name;
+}
+
+// Exact match first, then case-insensitive. column_count if there is none.
+internal u64
+db_view_find_column(DB_Table *table, String name) {
+    u64 found = table->column_count;
+    for (u64 c = 0; c < table->column_count; c++) {
+        DB_Column_Info *col = dyn_array_get(&table->columns, DB_Column_Info, c);
+        if (str_match(col->column_name, name) ||
+            (found == table->column_count && db_view_match_nocase(col->column_name, name))) {
+            found = c;
+        }
+    }
+    return found;
+}
+
+internal String
+db_view_error(Arena *arena, const char *message, String detail) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), message, (int)detail.size, (char *)detail.data);
+    return str_push_copy(arena, cstr_to_string(buf, strlen(buf)));
+}
+
+// Clauses joined by "and": column op value. Ops are = != <> < <= > >= like,
+// is null and is not null. Column names with spaces go in double quotes,
+// values may be in single quotes with '' for a quote.
+internal b32
+db_view_parse_filters(Arena *arena, DB_Table *table, String text, DB_Filter **out_filters, u64 *out_count, String *out_error) {
+    u64 clause_cap = 1;
+    for (u64 i = 0; i + 5 <= text.size; i++) {
+        clause_cap += db_view_match_nocase(str(text.data + i, 5), str_lit(" and "));
+    }
+    DB_Filter *filters = push_array_zero(arena, DB_Filter, clause_cap);
+    u64        count = 0;
+
+    String rest = db_view_trim(text);
+    while (rest.size) {
+        String     column = db_view_take_name(&rest, "=!<>");
+        DB_Filter *filter = &filters[count];
+        filter->column = db_view_find_column(table, column);
+        if (filter->column == table->column_count) {
+            *out_error = db_view_error(arena, "No column named %.*s", column);
+            return 0;
+        }
+
+        // Operator, longest first
+        rest = db_view_trim(rest);
+        struct {
+            const char  *text;
+            DB_Filter_Op op;
+            b32          is_word;
+        } ops[] = {
+            {"is not null", DB_FILTER_IS_NOT_NULL, 1},
+            {"is null", DB_FILTER_IS_NULL, 1},
+            {"like", DB_FILTER_LIKE, 1},
+            {"!=", DB_FILTER_NE, 0},
+            {"<>", DB_FILTER_NE, 0},
+            {"<=", DB_FILTER_LE, 0},
+            {">=", DB_FILTER_GE, 0},
+            {"=", DB_FILTER_EQ, 0},
+            {"<", DB_FILTER_LT, 0},
+            {">", DB_FILTER_GT, 0},
+        };
+        b32 found = 0;
+        for (u32 i = 0; i < ArrayCount(ops) && !found; i++) {
+            String op = cstr_to_string(ops[i].text, strlen(ops[i].text));
+            found = ops[i].is_word ? db_view_starts_with_word(rest, op)
+                                   : rest.size >= op.size && str_match(str(rest.data, op.size), op);
+            if (found) {
+                filter->op = ops[i].op;
+                rest = db_view_trim(str(rest.data + op.size, (u32)(rest.size - op.size)));
+            }
+        }
+        if (!found) {
+            *out_error = db_view_error(arena, "Expected an operator after %.*s", column);
+            return 0;
+        }
+
+        // Value, up to the next "and" outside quotes
+        u64 end = 0;
+        b32 in_quotes = 0;
+        for (; end < rest.size; end++) {
+            if (rest.data[end] == '\'') {
+                in_quotes = !in_quotes;
+            } else if (!in_quotes && db_view_char_is_space(rest.data[end]) &&
+                       db_view_starts_with_word(db_view_trim(str(rest.data + end, (u32)(rest.size - end))), str_lit("and"))) {
+                break;
+            }
+        }
+        String value = db_view_trim(str(rest.data, (u32)end));
+        rest = db_view_trim(str(rest.data + end, (u32)(rest.size - end)));
+        if (db_view_starts_with_word(rest, str_lit("and"))) {
+            rest = db_view_trim(str(rest.data + 3, (u32)(rest.size - 3)));
+        }
+
+        b32 takes_value = filter->op != DB_FILTER_IS_NULL && filter->op != DB_FILTER_IS_NOT_NULL;
+        if (takes_value && value.size >= 2 && value.data[0] == '\'' && value.data[value.size - 1] == '\'') {
+            u8 *unquoted = push_array(arena, u8, value.size);
+            u64 at = 0;
+            for (u64 i = 1; i + 1 < value.size; i++) {
+                unquoted[at++] = value.data[i];
+                if (value.data[i] == '\'' && value.data[i + 1] == '\'') {
+                    i++;
+                }
+            }
+            value = str(unquoted, (u32)at);
+        }
+        if (takes_value != (value.size > 0) && !(takes_value && filter->op == DB_FILTER_LIKE)) {
+            *out_error = db_view_error(arena, takes_value ? "Expected a value after %.*s" : "Unexpected %.*s", takes_value ? column : value);
+            return 0;
+        }
+        filter->value = value;
+
+        DB_Filter_Compiled compiled;
+        if (!db_view_compile_filter(table, filter, &compiled)) {
+            *out_error = db_view_error(arena, "%.*s doesn't fit the column's type", value);
+            return 0;
+        }
+        count++;
+    }
+
+    *out_filters = filters;
+    *out_count = count;
+    return 1;
+}
+
+////////////////////////////////
+// View
+
+// The table must not grow while this runs, build once its fetch is done
+internal DB_View
+db_view_build(Arena *arena, Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_Table *table,
+              DB_Filter *filters, u64 filter_count, DB_Sort_Key *keys, u64 key_count) {
+    PROF_FUNCTION;
+    DB_View view = {0};
+    u64     row_count = db_table_row_count(table);
+    view.table = table;
+    view.page_count = (row_count + DB_ROW_PAGE_CAP - 1) / DB_ROW_PAGE_CAP;
+    view.pages = push_array(arena, DB_Row_Page *, Max(view.page_count, 1));
+    view.rows = push_array(arena, u32, Max(view.page_count * DB_ROW_PAGE_CAP, 1));
+    DB_Row_Page *page = table->first_page;
+    for (u64 p = 0; p < view.page_count; p++, page = page->next) {
+        view.pages[p] = page;
+    }
+
+    Scratch             scratch = scratch_begin(arena);
+    DB_Filter_Compiled *compiled = push_array(scratch.arena, DB_Filter_Compiled, Max(filter_count, 1));
+    u64                 compiled_count = 0;
+    for (u64 i = 0; i < filter_count; i++) {
+        if (filters[i].column < table->column_count && db_view_compile_filter(table, &filters[i], &compiled[compiled_count])) {
+            compiled_count++;
+        }
+    }
+
+    if (view.page_count) {
+        u32                 task_count = (u32)Min(view.page_count, (u64)pool->worker_count * 4);
+        DB_View_Filter_Task task = {0};
+        task.view = &view;
+        task.filters = compiled;
+        task.filter_count = compiled_count;
+        task.ranges = thread_pool_divide_work(scratch.arena, view.page_count, task_count);
+        task.page_matches = push_array_zero(scratch.arena, u32, view.page_count);
+        thread_pool_for_parallel(pool, pool_arena, task_count, db_view_filter_task, &task);
+
+        // Pages wrote their matches at their own offset, close the gaps
+        for (u64 p = 0; p < view.page_count; p++) {
+            MemoryCopy(view.rows + view.count, view.rows + p * DB_ROW_PAGE_CAP, sizeof(u32) * task.page_matches[p]);
+            view.count += task.page_matches[p];
+        }
+    }
+    scratch_end(&scratch);
+
+    for (u64 k = key_count; k > 0; k--) {
+        if (keys[k - 1].column < table->column_count) {
+            db_view_sort_by(arena, &view, keys[k - 1]);
+        }
+    }
+    Prof_End();
+    return view;
+}
+
+internal DB_Row_Page *
+db_view_row(DB_View *view, u64 index, u64 *out_row_in_page) {
+    return db_view_page_of(view, view->rows[index], out_row_in_page);
+}
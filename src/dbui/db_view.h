@@ -0,0 +1,55 @@
+#pragma once
+#include "dbui.h"
+
+// Local filter and sort over a fetched DB_Table. Rows are never copied, a view
+// is a selection vector of table row indices in display order.
+//
+// Filters run a page at a time into a bitmask per page. Typed columns keep
+// their non-null values back to back, so comparisons run over those arrays
+// with SIMD and get spread over the rows only when the page has nulls. Text
+// columns compare numerically when both sides are numbers, which is what a
+// text format fetch of a numeric column needs.
+//
+// Multi-key sorts are one stable sort per key, least significant key first.
+// Fixed width keys (and text columns that only hold numbers) go through an
+// LSD radix sort on order preserving u64 keys, other text through a merge
+// sort. Nulls sort last ascending and first descending, like Postgres.
+
+typedef enum DB_Filter_Op {
+    DB_FILTER_EQ,
+    DB_FILTER_NE,
+    DB_FILTER_LT,
+    DB_FILTER_LE,
+    DB_FILTER_GT,
+    DB_FILTER_GE,
+    DB_FILTER_LIKE, // % and _ wildcards, case sensitive
+    DB_FILTER_IS_NULL,
+    DB_FILTER_IS_NOT_NULL,
+} DB_Filter_Op;
+
+typedef struct DB_Filter DB_Filter;
+struct DB_Filter {
+    u64          column;
+    DB_Filter_Op op;
+    String       value; // Text form, converted to the column's type once per build
+};
+
+typedef struct DB_Sort_Key DB_Sort_Key;
+struct DB_Sort_Key {
+    u64 column;
+    b32 descending;
+};
+
+typedef struct DB_View DB_View;
+struct DB_View {
+    DB_Table     *table;
+    DB_Row_Page **pages; // By page index, rows are looked up without walking the list
+    u64           page_count;
+    u32          *rows; // Selection vector, table row indices in view order
+    u64           count;
+};
+
+internal b32          db_view_parse_filters(Arena *arena, DB_Table *table, String text, DB_Filter **out_filters, u64 *out_count, String *out_error);
+internal DB_View      db_view_build(Arena *arena, Thread_Pool *pool, Thread_Pool_Arena *pool_arena, DB_Table *table,
+                                    DB_Filter *filters, u64 filter_count, DB_Sort_Key *keys, u64 key_count);
+internal DB_Row_Page *db_view_row(DB_View *view, u64 index, u64 *out_row_in_page);
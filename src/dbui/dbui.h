@@ -1,11 +1,46 @@
 #pragma once
 #include "../base/base_inc.h"
 
+typedef enum DB_Export_Format {
+    DB_EXPORT_FORMAT_CSV, // With a header line
+    DB_EXPORT_FORMAT_TEXT,
+    DB_EXPORT_FORMAT_BINARY,
+} DB_Export_Format;
+
+// TABLESAMPLE method for data browser samples
+typedef enum DB_Sample_Method {
+    DB_SAMPLE_NONE,      // The first rows
+    DB_SAMPLE_SYSTEM,    // Whole pages picked at random, reads only those
+    DB_SAMPLE_BERNOULLI, // Each row picked at random, reads every page
+} DB_Sample_Method;
+
 typedef struct Search_Config App_Config;
 struct Search_Config {
-    String pattern;
-    b32    search_files_only;
-    b32    recursive;
+    String           pattern;
+    b32              search_files_only;
+    b32              recursive;
+    b32              auto_layout;         // Force-directed schema graph layout on a background thread
+    u32              preview_page_rows;   // Rows per page the data browser fetches
+    u32              local_row_limit;     // Rows fetched when the data browser filters or sorts locally
+    DB_Sample_Method sample_method;       // Data browser sample mode
+    f32              sample_percent;      // Of the pages or rows sampled
+    u32              sample_row_limit;    // Rows kept of a sample at most
+    u32              cell_prefix;         // Characters of wide values the data browser fetches, the rest on demand
+    u32              db_connection_count; // Async query workers, each with its own lazily opened connection
+    b32              binary_results;      // Fetch data in binary format into typed columns
+    b32              zero_copy_results;   // Keep driver result buffers alive and point cells into them
+    b32              watch_schema;        // LISTEN for DDL notifications and patch changed tables into the graph
+    b32              install_ddl_trigger; // Create the event triggers that send them, needs superuser
+    DB_Export_Format export_format;       // Ctrl+E table exports and --export-query
+    String           export_query;        // Exported to export_path at startup if set
+    String           export_path;
+    String           import_path;  // CSV file imported into import_table at startup if set
+    String           import_table; // schema.table, or a table in public
+
+    // Schema graph level-of-detail thresholds, in on-screen pixels
+    f32 lod_label_min_px;  // Labels smaller than this are drawn as bars
+    f32 lod_column_min_px; // Column text smaller than this collapses into a block
+    f32 lod_edge_min_px;   // Arrowheads smaller than this switch edges to per node pair bundles
 };
 
 static inline App_Config
@@ -13,6 +48,17 @@ default_config() {
     App_Config c = {0};
     c.search_files_only = false;
     c.recursive = false;
+    c.auto_layout = true;
+    c.preview_page_rows = 256;
+    c.local_row_limit = 1000000;
+    c.sample_method = DB_SAMPLE_SYSTEM;
+    c.sample_percent = 1.0f;
+    c.sample_row_limit = 10000;
+    c.cell_prefix = 256;
+    c.db_connection_count = 4;
+    c.lod_label_min_px = 7.0f;
+    c.lod_column_min_px = 6.0f;
+    c.lod_edge_min_px = 4.0f;
     return c;
 }
 
@@ -32,6 +78,7 @@ struct DB_Config {
     union {
         String connection_string;
     };
+    u32 connect_timeout_ms; // 0 = default
 };
 
 typedef union DB_Handle DB_Handle;
@@ -47,6 +94,13 @@ struct DB_Conn {
     Arena    *arena;
     DB_Kind   kind;
     DB_Handle handle;
+    u32       connect_timeout_ms; // Also bounds reconnects
+
+    // Prepared statements on this connection, statement text -> id. Own arena,
+    // callers hold scratch on the connection arena while statements get prepared.
+    Arena      *statement_arena;
+    Hash_Table *statements;
+    u64         statement_count;
 };
 
 typedef enum DB_Schema_Kind {
@@ -59,8 +113,8 @@ typedef enum DB_Schema_Kind {
 typedef struct DB_Schema DB_Schema;
 struct DB_Schema {
     DB_Schema_Kind kind;
-    String schema;
-    String name;
+    String         schema;
+    String         name;
 };
 
 typedef struct DB_Schema_Node DB_Schema_Node;
@@ -77,6 +131,25 @@ struct DB_Schema_List {
     u64             count;
 };
 
+// How a result column is stored in its chunks. TEXT and BYTES are variable
+// length blobs, the rest are fixed width values in host byte order.
+typedef enum DB_Column_Type {
+    DB_COLUMN_TEXT,
+    DB_COLUMN_BYTES, // Binary values of types we don't decode, shown as hex
+    DB_COLUMN_BOOL,  // u8
+    DB_COLUMN_INT16,
+    DB_COLUMN_INT32,
+    DB_COLUMN_INT64,
+    DB_COLUMN_FLOAT32,
+    DB_COLUMN_FLOAT64,
+    DB_COLUMN_NUMERIC,     // f64 sort key, then the exact decimal text
+    DB_COLUMN_DATE,        // s32 days since 2000-01-01
+    DB_COLUMN_TIMESTAMP,   // s64 microseconds since 2000-01-01
+    DB_COLUMN_TIMESTAMPTZ, // s64 microseconds since 2000-01-01 UTC
+    DB_COLUMN_UUID,        // 16 bytes
+    DB_COLUMN_TYPE_COUNT,
+} DB_Column_Type;
+
 typedef struct DB_Column_Info DB_Column_Info;
 struct DB_Column_Info {
     String column_name;
@@ -84,33 +157,276 @@ struct DB_Column_Info {
     String is_nullable;
     String column_default;
     String is_foreign_key;
+    String foreign_schema_name;
     String foreign_table_name;
     String foreign_column_name;
 
     char *display_text; // "column_name: data_type"
     char *fk_display;   // "→ foreign_table"
     b32   is_fk;
+
+    DB_Column_Type type; // Storage of result data, TEXT unless fetched in binary format
+    u32            type_modifier;
+    b32            is_truncated; // Wide values were cut to a prefix, see DB_Column_Chunk.full_sizes
+};
+
+// Rows live in fixed size pages so appending never moves rows that were
+// already published. A streaming fetch keeps appending while the UI reads.
+// Inside a page storage is column-major: each column keeps its values back to
+// back in one blob, with an offset per row and a null bit per row.
+#define DB_ROW_PAGE_CAP 1024
+
+typedef struct DB_Column_Chunk DB_Column_Chunk;
+struct DB_Column_Chunk {
+    u8 *data; // May be swapped for a bigger copy while streaming, read atomically
+    u64 data_size;
+    u64 data_cap;
+    u32 offsets[DB_ROW_PAGE_CAP + 1]; // Row r is data[offsets[r], offsets[r + 1])
+    u64 nulls[DB_ROW_PAGE_CAP / 64];  // Bit set = SQL NULL
+
+    String *refs;       // Zero copy tables only: row r is refs[r], data then only holds decoded values
+    u64    *full_sizes; // Truncated columns only: bytes of row r's whole value, 0 if the cell holds all of it
+};
+
+typedef struct DB_Row_Page DB_Row_Page;
+struct DB_Row_Page {
+    DB_Row_Page     *next;
+    u64              count;
+    DB_Column_Chunk *columns;  // column_count chunks
+    String          *locators; // Tables with truncated columns: "tableoid ctid" of each row, to fetch whole values by
 };
 
-typedef struct DB_Row DB_Row;
-struct DB_Row {
-    Dyn_Array values; // Array of String values
+// A driver result a zero copy table points into, freed with the table
+typedef struct DB_Retained_Result DB_Retained_Result;
+struct DB_Retained_Result {
+    DB_Retained_Result *next;
+    DB_Kind             kind;
+    DB_Handle           handle;
+};
+
+#define DB_PAGE_KEY_MAX        8
+#define DB_PROJECTION_WIDE_MAX 32
+
+// Select list the data browser fetches a table with. Text, json, xml and bytea
+// columns are cut to a prefix, so a page doesn't pull whole documents to show a
+// few characters of each. Behind the projected columns the result has the
+// whole size of each cut value, then the row's locator.
+typedef struct DB_Projection DB_Projection;
+struct DB_Projection {
+    b32    is_resolved;
+    String select_list;  // Empty = *, nothing to cut
+    u32    column_count; // Projected columns, the ones the table shows
+    u32    wide_count;   // Cut columns, any past DB_PROJECTION_WIDE_MAX are fetched whole
+    u32    wide_columns[DB_PROJECTION_WIDE_MAX];
+};
+
+// Where a page starts when a table is browsed page by page. With a primary key
+// the page is an index range scan from the previous page's last key, so any
+// depth costs the same. Without one it falls back to OFFSET.
+typedef struct DB_Page_Key DB_Page_Key;
+struct DB_Page_Key {
+    b32    is_resolved;  // Key columns looked up, the first page request leaves this 0
+    u32    column_count; // Primary key columns, 0 = no usable key, page by offset
+    String columns[DB_PAGE_KEY_MAX];
+    String values[DB_PAGE_KEY_MAX]; // Text form of the key of the row before the page
+    b32    has_values;              // 0 = start of the table
+    u64    offset;                  // Rows before the page
 };
 
 typedef struct DB_Table DB_Table;
 struct DB_Table {
-    Arena    *arena;
-    DB_Schema schema;
-    Dyn_Array columns; // Array of DB_Column_Info
-    Dyn_Array rows;    // Array of DB_Row
-    u64       row_count;
-    u64       column_count;
+    Arena       *arena;
+    DB_Schema    schema;
+    Dyn_Array    columns; // Array of DB_Column_Info
+    DB_Row_Page *first_page;
+    DB_Row_Page *last_page;
+    u64          row_count; // Rows readable by other threads, only ever grows, use db_table_row_count
+    u64          column_count;
+
+    b32                 zero_copy; // Set before the first row, cells reference retained results
+    DB_Retained_Result *first_retained;
+
+    // Streaming state, accessed atomically
+    b32 is_streaming;     // Set until the final result for the fetch is delivered
+    b32 cancel_requested; // Reader is no longer interested, the fetch stops early
+    b32 stream_failed;
+
+    DB_Projection projection; // Select list it was fetched with, strings live in the table arena
+
+    // DB_REQUEST_TABLE_PAGE
+    DB_Page_Key next_page; // Where the following page starts, strings live in the table arena
+    b32         is_last_page;
+};
+
+// Everything the schema graph is built from: the schema list plus column info
+// for every table. Loaded from the on-disk cache or fetched from the server.
+typedef struct DB_Catalog DB_Catalog;
+struct DB_Catalog {
+    Arena         *arena;
+    DB_Schema_List schemas;
+    u64            table_count;
+    DB_Table     **tables;      // One per DB_SCHEMA_KIND_TABLE entry in list order, null if unknown
+    u64            fingerprint; // Changes whenever the server's catalog does, 0 = unknown
+    void          *map;         // Cache file view the strings point into, if loaded from one
+    u64            map_size;
+};
+
+// Async queries: submit returns a ticket, the DB worker thread runs the query on
+// its own connection and completed tables come back through db_async_poll.
+typedef u64 DB_Ticket; // 0 = invalid
+
+typedef enum DB_Request_Kind {
+    DB_REQUEST_SCHEMA_INFO,
+    DB_REQUEST_TABLE_DATA,
+    DB_REQUEST_TABLE_PAGE,    // One page of rows starting at after, see DB_Page_Key
+    DB_REQUEST_CATALOG,       // Refetch the catalog if its fingerprint changed, and rewrite the cache file
+    DB_REQUEST_EXPORT,        // COPY a table or query straight into a local file
+    DB_REQUEST_IMPORT,        // COPY CSV records into a table, one slice of a file per request
+    DB_REQUEST_SCHEMA_CHANGE, // Never submitted, posted by the DDL listener for each changed table
+    DB_REQUEST_ROW_ESTIMATES, // Planner row counts of every table: schema, table, rows (null if never analyzed)
+    DB_REQUEST_CELL_VALUE,    // Whole value of a truncated cell, one row and column
+} DB_Request_Kind;
+
+typedef struct DB_Async DB_Async;
+
+typedef struct DB_Request DB_Request;
+struct DB_Request {
+    DB_Request     *next;
+    DB_Ticket       ticket;
+    DB_Request_Kind kind;
+    DB_Schema       schema; // Strings are copied by db_async_submit
+    u32             limit;
+    b32             binary;    // Fetch in binary result format and decode into typed columns
+    b32             zero_copy; // Cells point into the driver's result buffers instead of copies
+    u64             user_data;
+    DB_Async       *async; // For posting partial results while streaming
+    Arena          *arena; // Queued copies only: holds the strings db_async_submit copies, kept across reuse
+
+    // DB_REQUEST_TABLE_DATA, rows come from a TABLESAMPLE unless the method is none
+    DB_Sample_Method sample_method;
+    f32              sample_percent;
+
+    // DB_REQUEST_TABLE_DATA and DB_REQUEST_TABLE_PAGE, resolved by the worker if it isn't yet
+    DB_Projection projection;  // Strings are copied by db_async_submit
+    u32           cell_prefix; // Characters, or bytes of bytea, kept of wide values. 0 = whole values
+
+    // DB_REQUEST_CELL_VALUE, from schema's table
+    String cell_column;  // Copied by db_async_submit
+    String cell_locator; // From the row's page, copied by db_async_submit
+
+    // DB_REQUEST_TABLE_PAGE, limit is the page size
+    DB_Page_Key after; // Strings are copied by db_async_submit
+
+    // DB_REQUEST_EXPORT, exports query if set, schema's table otherwise
+    String           export_query; // Must outlive the request
+    String           export_path;  // Must outlive the request
+    DB_Export_Format export_format;
+
+    // DB_REQUEST_IMPORT, into schema's table
+    String  import_data;         // CSV records without the header line, must outlive the request
+    String *import_columns;      // Named by the header line, must outlive the request
+    u64     import_column_count;
+
+    // DB_REQUEST_CATALOG
+    u64    fingerprint; // Of the catalog the UI already has
+    String cache_path;  // Must outlive the request
+};
+
+typedef struct DB_Result DB_Result;
+struct DB_Result {
+    DB_Result      *next;
+    DB_Ticket       ticket;
+    DB_Request_Kind kind;
+    u64             user_data;
+    DB_Table       *table;      // Null if the query failed, owned by the receiver
+    b32             is_partial; // Table is still streaming rows, a final result with the same table follows
+    DB_Catalog     *catalog;    // DB_REQUEST_CATALOG: null if unchanged or the fetch failed, owned by the receiver
+    b32             is_dropped; // DB_REQUEST_SCHEMA_CHANGE: the table is gone, table only carries its schema
+
+    // DB_REQUEST_EXPORT and DB_REQUEST_IMPORT, partial results only report progress
+    u64 copy_bytes; // Moved through COPY so far
+    u64 copy_rows;  // Final result only
+    b32 copy_ok;    // Final result only
+};
+
+typedef struct DB_Result_List DB_Result_List;
+struct DB_Result_List {
+    DB_Result *first;
+    DB_Result *last;
+    u64        count;
+};
+
+// One per pooled connection. The connection is opened on the first request
+// and checked before every batch, only the worker's own thread touches it.
+typedef struct DB_Async_Worker DB_Async_Worker;
+struct DB_Async_Worker {
+    DB_Async *async;
+    DB_Conn  *conn;
+    OS_Handle thread;
+};
+
+struct DB_Async {
+    Arena           *arena;
+    DB_Config        config;
+    u32              worker_count;
+    DB_Async_Worker *workers;
+    Semaphore        wake;
+    b32              is_live;
+
+    // DDL listener, only running after db_async_watch_ddl
+    OS_Handle listener;
+    DB_Conn  *listener_conn;
+    Semaphore listener_stop; // Signaled on release, cuts reconnect backoff short
+    b32       listener_install_trigger;
+
+    // Guarded by mutex
+    Mutex       mutex;
+    DB_Request *first_request;
+    DB_Request *last_request;
+    DB_Request *free_request;
+    DB_Result  *first_result;
+    DB_Result  *last_result;
+    DB_Result  *free_result;
+    DB_Ticket   next_ticket;
 };
 
 internal b32            parse_args(Cmd_Line *cmd, App_Config *config);
 internal void           print_help(String bin_name);
 internal DB_Conn       *db_connect(DB_Config config);
+internal void           db_disconnect(DB_Conn *conn);
+internal b32            db_check_connection(DB_Conn *conn);
 internal DB_Schema_List db_get_all_schemas(DB_Conn *conn);
 internal DB_Table      *db_get_schema_info(DB_Conn *conn, DB_Schema schema);
+internal b32            db_get_all_schema_info(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables);
+internal b32            db_get_schema_info_batch(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables);
+internal b32            db_watch_ddl(DB_Conn *conn, b32 install_trigger);
+internal b32            db_wait_ddl(DB_Conn *conn, Arena *arena, s32 timeout_ms, DB_Schema_List *tables);
 internal void           db_free_schema_info(DB_Table *table);
+internal u64            db_get_catalog_fingerprint(DB_Conn *conn);
 internal DB_Table      *db_get_data_from_schema(DB_Conn *conn, DB_Schema schema, u32 limit);
+internal b32            db_export(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows);
+internal b32            db_import(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows);
+internal DB_Async      *db_async_alloc(DB_Config config, u32 worker_count);
+internal void           db_async_release(DB_Async *async);
+internal void           db_async_watch_ddl(DB_Async *async, b32 install_trigger);
+internal DB_Ticket      db_async_submit(DB_Async *async, DB_Request *params);
+internal DB_Result_List db_async_poll(DB_Async *async, Arena *arena);
+internal void           db_async_post_partial(DB_Async *async, DB_Request *request, DB_Table *table);
+internal void           db_async_post_result(DB_Async *async, DB_Request *request, DB_Table *table);
+internal void           db_async_post_copy_progress(DB_Async *async, DB_Request *request, u64 bytes);
+internal DB_Table      *db_table_alloc(DB_Schema schema);
+internal String         db_schema_key(Arena *arena, String schema, String name);
+internal void           db_table_push_row(DB_Table *table);
+internal void           db_table_push_cell(DB_Table *table, u64 column, String value, b32 is_null);
+internal void           db_table_push_cell_ref(DB_Table *table, u64 column, String value, b32 is_null);
+internal void           db_table_retain(DB_Table *table, DB_Kind kind, DB_Handle handle);
+internal void           db_table_set_full_size(DB_Table *table, u64 column, u64 size);
+internal void           db_table_set_locator(DB_Table *table, String locator);
+internal void           db_table_publish_rows(DB_Table *table, u64 row_count);
+internal u64            db_table_row_count(DB_Table *table);
+internal DB_Row_Page   *db_table_page(DB_Table *table, u64 row);
+internal String         db_page_cell(DB_Row_Page *page, u64 row_in_page, u64 column);
+internal String         db_page_cell_format(Arena *arena, DB_Row_Page *page, u64 row_in_page, u64 column, DB_Column_Type type);
+internal u32            db_column_type_size(DB_Column_Type type);
+internal b32            db_page_cell_is_null(DB_Row_Page *page, u64 row_in_page, u64 column);
+internal u64            db_page_cell_full_size(DB_Row_Page *page, u64 row_in_page, u64 column);
@@ -0,0 +1,375 @@
+#include "graph_layout.h"
+
+typedef struct Graph_Layout_Step Graph_Layout_Step;
+struct Graph_Layout_Step {
+    Graph_Layout      *layout;
+    Graph_Layout_Tree *tree;
+    Rng1_u64          *ranges;
+    Vec2_f32          *read;
+    Vec2_f32          *write;
+    b32               *pinned; // Snapshot taken at the start of the iteration
+    Vec2_f32           centroid;
+    f32               *max_displacement; // One per task
+};
+
+internal s32
+graph_layout_quad_push(Arena *arena, Graph_Layout_Tree *tree, Vec2_f32 center, f32 half_size) {
+    if (tree->count == tree->cap) {
+        u32                new_cap = tree->cap ? tree->cap * 2 : 256;
+        Graph_Layout_Quad *quads = push_array(arena, Graph_Layout_Quad, new_cap);
+        if (tree->quads) {
+            MemoryCopy(quads, tree->quads, sizeof(Graph_Layout_Quad) * tree->count);
+        }
+        tree->quads = quads;
+        tree->cap = new_cap;
+    }
+    s32                index = (s32)tree->count++;
+    Graph_Layout_Quad *quad = &tree->quads[index];
+    quad->center = center;
+    quad->half_size = half_size;
+    quad->mass_center = (Vec2_f32){{0.0f, 0.0f}};
+    quad->mass = 0.0f;
+    quad->children[0] = quad->children[1] = quad->children[2] = quad->children[3] = -1;
+    quad->point = -1;
+    return index;
+}
+
+internal u32
+graph_layout_quadrant(Graph_Layout_Quad *quad, Vec2_f32 p) {
+    return (p.x >= quad->center.x ? 1 : 0) | (p.y >= quad->center.y ? 2 : 0);
+}
+
+internal s32
+graph_layout_quad_child(Arena *arena, Graph_Layout_Tree *tree, s32 parent, u32 quadrant) {
+    Graph_Layout_Quad *quad = &tree->quads[parent];
+    if (quad->children[quadrant] < 0) {
+        f32      h = quad->half_size * 0.5f;
+        Vec2_f32 c = {{quad->center.x + ((quadrant & 1) ? h : -h),
+                       quad->center.y + ((quadrant & 2) ? h : -h)}};
+        s32      child = graph_layout_quad_push(arena, tree, c, h);
+        // quads may have moved while growing
+        tree->quads[parent].children[quadrant] = child;
+    }
+    return tree->quads[parent].children[quadrant];
+}
+
+internal void
+graph_layout_tree_build(Arena *arena, Graph_Layout_Tree *tree, Vec2_f32 *positions, u32 count) {
+    MemoryZeroStruct(tree);
+    if (count == 0)
+        return;
+
+    Rng2_f32 bounds = {{{positions[0].x, positions[0].y}}, {{positions[0].x, positions[0].y}}};
+    for (u32 i = 1; i < count; i++) {
+        bounds.min.x = Min(bounds.min.x, positions[i].x);
+        bounds.min.y = Min(bounds.min.y, positions[i].y);
+        bounds.max.x = Max(bounds.max.x, positions[i].x);
+        bounds.max.y = Max(bounds.max.y, positions[i].y);
+    }
+    Vec2_f32 center = {{(bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f}};
+    f32      half_size = Max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y) * 0.5f + 1.0f;
+    graph_layout_quad_push(arena, tree, center, half_size);
+
+    for (u32 i = 0; i < count; i++) {
+        Vec2_f32 p = positions[i];
+        s32      quad = 0;
+        for (u32 depth = 0;; depth++) {
+            Graph_Layout_Quad *q = &tree->quads[quad];
+
+            // Accumulate mass on the way down, every quad on the path contains p
+            f32 mass = q->mass + 1.0f;
+            q->mass_center.x += (p.x - q->mass_center.x) / mass;
+            q->mass_center.y += (p.y - q->mass_center.y) / mass;
+            q->mass = mass;
+
+            b32 is_leaf = q->children[0] < 0 && q->children[1] < 0 && q->children[2] < 0 && q->children[3] < 0;
+            if (is_leaf && q->point < 0 && mass == 1.0f) {
+                q->point = (s32)i;
+                break;
+            }
+            if (depth >= GRAPH_LAYOUT_TREE_MAX_DEPTH) {
+                // Coincident nodes share the leaf as an aggregate
+                q->point = -1;
+                break;
+            }
+            if (is_leaf && q->point >= 0) {
+                // Push the resident point one level down before descending
+                s32      resident = q->point;
+                Vec2_f32 rp = positions[resident];
+                q->point = -1;
+                s32                child = graph_layout_quad_child(arena, tree, quad, graph_layout_quadrant(&tree->quads[quad], rp));
+                Graph_Layout_Quad *c = &tree->quads[child];
+                c->mass = 1.0f;
+                c->mass_center = rp;
+                c->point = resident;
+            }
+            quad = graph_layout_quad_child(arena, tree, quad, graph_layout_quadrant(&tree->quads[quad], p));
+        }
+    }
+}
+
+internal Vec2_f32
+graph_layout_repulsion(Graph_Layout_Tree *tree, Vec2_f32 *positions, u32 index, f32 k2) {
+    Vec2_f32 force = {{0.0f, 0.0f}};
+    Vec2_f32 p = positions[index];
+
+    s32 stack[GRAPH_LAYOUT_TREE_MAX_DEPTH * 4 + 4];
+    u32 stack_count = 0;
+    stack[stack_count++] = 0;
+
+    while (stack_count > 0) {
+        Graph_Layout_Quad *q = &tree->quads[stack[--stack_count]];
+        if (q->mass == 0.0f || q->point == (s32)index)
+            continue;
+
+        f32 dx = p.x - q->mass_center.x;
+        f32 dy = p.y - q->mass_center.y;
+        f32 d2 = dx * dx + dy * dy;
+
+        b32 is_leaf = q->children[0] < 0 && q->children[1] < 0 && q->children[2] < 0 && q->children[3] < 0;
+        f32 size = q->half_size * 2.0f;
+        if (is_leaf || size * size < GRAPH_LAYOUT_THETA * GRAPH_LAYOUT_THETA * d2) {
+            f32 mass = q->mass;
+            if (is_leaf && q->point < 0) {
+                // Aggregate leaf at max depth can contain the node itself
+                Vec2_f32 d = {{p.x - q->mass_center.x, p.y - q->mass_center.y}};
+                if (d.x == 0.0f && d.y == 0.0f)
+                    mass -= 1.0f;
+            }
+            if (d2 < 0.01f) {
+                // Overlapping, nudge apart along a per-node direction
+                dx = (f32)((index * 7919u) % 13u) - 6.0f + 0.5f;
+                dy = (f32)((index * 104729u) % 13u) - 6.0f + 0.5f;
+                d2 = dx * dx + dy * dy;
+            }
+            // Fruchterman-Reingold repulsion k^2 / d along the unit vector
+            f32 scale = mass * k2 / d2;
+            force.x += dx * scale;
+            force.y += dy * scale;
+        } else {
+            for (u32 c = 0; c < 4; c++) {
+                if (q->children[c] >= 0 && stack_count < ArrayCount(stack)) {
+                    stack[stack_count++] = q->children[c];
+                }
+            }
+        }
+    }
+    return force;
+}
+
+internal THREAD_POOL_TASK_FUNC(graph_layout_step_task) {
+    Graph_Layout_Step *step = (Graph_Layout_Step *)raw_task;
+    Graph_Layout      *layout = step->layout;
+    Rng1_u64           range = step->ranges[task_id];
+    f32                k = layout->ideal_length;
+    f32                k2 = k * k;
+    f32                temperature = layout->temperature;
+    f32                max_displacement = 0.0f;
+
+    for (u64 i = range.min; i < range.max; i++) {
+        Vec2_f32 p = step->read[i];
+        if (step->pinned[i]) {
+            step->write[i] = p;
+            continue;
+        }
+
+        Vec2_f32 force = graph_layout_repulsion(step->tree, step->read, (u32)i, k2);
+
+        // Spring attraction d^2 / k toward each FK neighbour
+        for (u32 e = layout->adjacency_offsets[i]; e < layout->adjacency_offsets[i + 1]; e++) {
+            Vec2_f32 q = step->read[layout->adjacency[e]];
+            f32      dx = q.x - p.x;
+            f32      dy = q.y - p.y;
+            f32      d = sqrtf(dx * dx + dy * dy);
+            force.x += dx * d / k;
+            force.y += dy * d / k;
+        }
+
+        // Weak gravity keeps disconnected components from drifting off
+        force.x += (step->centroid.x - p.x) * 0.01f;
+        force.y += (step->centroid.y - p.y) * 0.01f;
+
+        f32 len = sqrtf(force.x * force.x + force.y * force.y);
+        if (len > temperature) {
+            force.x *= temperature / len;
+            force.y *= temperature / len;
+            len = temperature;
+        }
+        step->write[i] = (Vec2_f32){{p.x + force.x, p.y + force.y}};
+        max_displacement = Max(max_displacement, len);
+    }
+    step->max_displacement[task_id] = max_displacement;
+}
+
+internal void
+graph_layout_thread_main(void *ptr) {
+    Graph_Layout *layout = (Graph_Layout *)ptr;
+    Arena        *arena = arena_alloc();
+    u32           task_count = layout->pool->worker_count * 4;
+    b32          *pinned = push_array_zero(arena, b32, Max(layout->node_count, 1));
+
+    while (ins_atomic_u32_eval(&layout->is_live) && !layout->is_done) {
+        Prof_Begin("GraphLayoutStep");
+        Scratch   scratch = scratch_begin(arena);
+        Vec2_f32 *read = layout->positions[layout->current];
+        Vec2_f32 *write = layout->positions[!layout->current];
+
+        // Take the UI's pins for this iteration
+        os_mutex_lock(layout->mutex);
+        for (u32 i = 0; i < layout->node_count; i++) {
+            pinned[i] = layout->pinned[i];
+            if (pinned[i]) {
+                read[i] = layout->pinned_positions[i];
+            }
+        }
+        os_mutex_unlock(layout->mutex);
+
+        Vec2_f32 centroid = {{0.0f, 0.0f}};
+        for (u32 i = 0; i < layout->node_count; i++) {
+            centroid.x += read[i].x;
+            centroid.y += read[i].y;
+        }
+        centroid.x /= (f32)layout->node_count;
+        centroid.y /= (f32)layout->node_count;
+
+        Graph_Layout_Tree tree;
+        graph_layout_tree_build(scratch.arena, &tree, read, layout->node_count);
+
+        Graph_Layout_Step step = {0};
+        step.layout = layout;
+        step.tree = &tree;
+        step.ranges = thread_pool_divide_work(scratch.arena, layout->node_count, task_count);
+        step.read = read;
+        step.write = write;
+        step.pinned = pinned;
+        step.centroid = centroid;
+        step.max_displacement = push_array_zero(scratch.arena, f32, task_count);
+        thread_pool_for_parallel(layout->pool, layout->pool_arena, task_count, graph_layout_step_task, &step);
+
+        f32 max_displacement = 0.0f;
+        for (u32 i = 0; i < task_count; i++) {
+            max_displacement = Max(max_displacement, step.max_displacement[i]);
+        }
+        layout->current = !layout->current;
+        layout->iteration += 1;
+        layout->temperature *= 0.97f;
+        if (layout->iteration >= GRAPH_LAYOUT_MAX_ITERATIONS || max_displacement < 0.5f) {
+            layout->is_done = 1;
+        }
+
+        os_mutex_lock(layout->mutex);
+        MemoryCopy(layout->published, write, sizeof(Vec2_f32) * layout->node_count);
+        layout->published_generation += 1;
+        os_mutex_unlock(layout->mutex);
+
+        scratch_end(&scratch);
+        Prof_End();
+    }
+    arena_release(arena);
+}
+
+internal Graph_Layout *
+graph_layout_alloc(Vec2_f32 *positions, u32 node_count, u32 *edge_pairs, u64 edge_count, f32 ideal_length) {
+    Arena        *arena = arena_alloc();
+    Graph_Layout *layout = push_struct_zero(arena, Graph_Layout);
+    u32           cap = Max(node_count, 1);
+    layout->arena = arena;
+    // Half the cores, the rest stay free for the UI thread and the shared pool
+    layout->pool = thread_pool_alloc(arena, os_get_system_info().num_threads / 2, 16, str_lit("graph_layout"));
+    layout->pool_arena = thread_pool_arena_alloc(layout->pool);
+    layout->node_count = node_count;
+    layout->ideal_length = ideal_length;
+    layout->temperature = ideal_length * 2.0f;
+    layout->mutex = os_mutex_create();
+
+    for (u32 i = 0; i < 2; i++) {
+        layout->positions[i] = push_array(arena, Vec2_f32, cap);
+        MemoryCopy(layout->positions[i], positions, sizeof(Vec2_f32) * node_count);
+    }
+    layout->published = push_array(arena, Vec2_f32, cap);
+    MemoryCopy(layout->published, positions, sizeof(Vec2_f32) * node_count);
+    layout->pinned = push_array_zero(arena, b32, cap);
+    layout->pinned_positions = push_array_zero(arena, Vec2_f32, cap);
+
+    // Undirected CSR adjacency: count degrees, prefix sum, then fill
+    layout->adjacency_offsets = push_array_zero(arena, u32, node_count + 1);
+    layout->adjacency = push_array(arena, u32, Max(edge_count * 2, 1));
+    for (u64 e = 0; e < edge_count; e++) {
+        u32 a = edge_pairs[e * 2 + 0];
+        u32 b = edge_pairs[e * 2 + 1];
+        if (a != b) {
+            layout->adjacency_offsets[a + 1] += 1;
+            layout->adjacency_offsets[b + 1] += 1;
+        }
+    }
+    for (u32 i = 0; i < node_count; i++) {
+        layout->adjacency_offsets[i + 1] += layout->adjacency_offsets[i];
+    }
+    Scratch scratch = scratch_begin(arena);
+    u32    *fill = push_array(scratch.arena, u32, cap);
+    MemoryCopy(fill, layout->adjacency_offsets, sizeof(u32) * node_count);
+    for (u64 e = 0; e < edge_count; e++) {
+        u32 a = edge_pairs[e * 2 + 0];
+        u32 b = edge_pairs[e * 2 + 1];
+        if (a != b) {
+            layout->adjacency[fill[a]++] = b;
+            layout->adjacency[fill[b]++] = a;
+        }
+    }
+    scratch_end(&scratch);
+
+    return layout;
+}
+
+internal void
+graph_layout_start(Graph_Layout *layout) {
+    if (layout->node_count < 2) {
+        layout->is_done = 1;
+        return;
+    }
+    layout->is_live = 1;
+    layout->thread = os_thread_create(graph_layout_thread_main, layout);
+}
+
+internal void
+graph_layout_release(Graph_Layout *layout) {
+    if (!layout)
+        return;
+    if (ins_atomic_u32_eval(&layout->is_live)) {
+        ins_atomic_u32_eval_assign(&layout->is_live, 0);
+        os_thread_join(layout->thread);
+    }
+    os_mutex_destroy(layout->mutex);
+    thread_pool_arena_release(&layout->pool_arena);
+    thread_pool_release(layout->pool);
+    arena_release(layout->arena);
+}
+
+// Copies the newest finished iteration into positions, skipping pinned nodes
+// since the UI owns those. Returns 1 when anything new was copied.
+internal b32
+graph_layout_pull(Graph_Layout *layout, Vec2_f32 *positions) {
+    b32 result = 0;
+    os_mutex_lock(layout->mutex);
+    if (layout->published_generation != layout->pulled_generation) {
+        for (u32 i = 0; i < layout->node_count; i++) {
+            if (!layout->pinned[i]) {
+                positions[i] = layout->published[i];
+            }
+        }
+        layout->pulled_generation = layout->published_generation;
+        result = 1;
+    }
+    os_mutex_unlock(layout->mutex);
+    return result;
+}
+
+internal void
+graph_layout_pin(Graph_Layout *layout, u32 index, Vec2_f32 position) {
+    if (index >= layout->node_count)
+        return;
+    os_mutex_lock(layout->mutex);
+    layout->pinned[index] = 1;
+    layout->pinned_positions[index] = position;
+    os_mutex_unlock(layout->mutex);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "../base/base_inc.h"
+
+// Force-directed layout for the schema graph (Fruchterman-Reingold forces,
+// Barnes-Hut quadtree for repulsion). The simulation runs on its own thread and
+// fans each iteration out over its own thread pool, so UI work on the shared
+// pool never queues behind an iteration. It steps between two position buffers
+// and publishes finished iterations into a third one that the UI pulls from
+// once per frame, so the UI never waits on a running iteration.
+
+#define GRAPH_LAYOUT_THETA          0.8f // Barnes-Hut opening angle, cell size / distance
+#define GRAPH_LAYOUT_MAX_ITERATIONS 1500
+#define GRAPH_LAYOUT_TREE_MAX_DEPTH 24 // Coincident points stop subdividing here
+
+typedef struct Graph_Layout_Quad Graph_Layout_Quad;
+struct Graph_Layout_Quad {
+    Vec2_f32 center; // Of the cell, not the mass
+    f32      half_size;
+    Vec2_f32 mass_center;
+    f32      mass;
+    s32      children[4]; // -1 = empty
+    s32      point;       // Leaf holding a single node, -1 otherwise
+};
+
+typedef struct Graph_Layout_Tree Graph_Layout_Tree;
+struct Graph_Layout_Tree {
+    Graph_Layout_Quad *quads;
+    u32                count;
+    u32                cap;
+};
+
+typedef struct Graph_Layout Graph_Layout;
+struct Graph_Layout {
+    Arena             *arena;
+    Thread_Pool       *pool;
+    Thread_Pool_Arena *pool_arena;
+    OS_Handle          thread;
+
+    u32  node_count;
+    u32 *adjacency_offsets; // CSR over both edge directions, node_count + 1 entries
+    u32 *adjacency;
+
+    Vec2_f32 *positions[2]; // Simulation double buffer, owned by the layout thread
+    u32       current;
+
+    // Shared with the UI thread, guarded by mutex
+    Mutex     mutex;
+    Vec2_f32 *published;
+    b32      *pinned; // Nodes the user has dragged, they stay where they were put
+    Vec2_f32 *pinned_positions;
+    u64       published_generation;
+
+    u64 pulled_generation; // UI thread only
+    f32 ideal_length;
+    f32 temperature;
+    u32 iteration;
+    b32 is_live;
+    b32 is_done;
+};
+
+internal Graph_Layout *graph_layout_alloc(Vec2_f32 *positions, u32 node_count, u32 *edge_pairs, u64 edge_count, f32 ideal_length);
+internal void          graph_layout_start(Graph_Layout *layout);
+internal void          graph_layout_release(Graph_Layout *layout);
+internal b32           graph_layout_pull(Graph_Layout *layout, Vec2_f32 *positions);
+internal void          graph_layout_pin(Graph_Layout *layout, u32 index, Vec2_f32 position);
@@ -1,6 +1,9 @@
 #include "postgres.h"
 #include <unistd.h>
 #include <stdio.h>
+#include <poll.h>
+#include <errno.h>
+#include <math.h>
 
 DB_Handle conn_to_handle(PGconn *conn) {
     DB_Handle handle = {0};
@@ -13,39 +16,80 @@ static inline PGconn *handle_to_conn(DB_Handle handle) {
     return conn;
 }
 
-internal DB_Conn *
-pg_connect(DB_Config config) {
-    Arena   *arena = arena_alloc();
-    DB_Conn *db_conn = push_struct(arena, DB_Conn);
-    db_conn->arena = arena;
-
-    PGconn *conn = PQconnectdb(str_to_cstring(arena, config.connection_string));
-    if (PQstatus(conn) == CONNECTION_BAD) {
-        log_error("Could not connect to postgres db");
+// Waits until the socket is ready for events (POLLIN/POLLOUT) or timeout_ms
+// passes. Returns 0 on socket errors.
+internal b32
+pg_wait_socket(PGconn *c, s16 events, s32 timeout_ms) {
+    struct pollfd pfd = {0};
+    pfd.fd = PQsocket(c);
+    pfd.events = events;
+    if (pfd.fd < 0) {
         return 0;
     }
+    s32 rc = poll(&pfd, 1, timeout_ms);
+    return rc >= 0 || errno == EINTR;
+}
+
+internal b32
+pg_wait_readable(PGconn *c, s32 timeout_ms) {
+    return pg_wait_socket(c, POLLIN, timeout_ms);
+}
 
-    PostgresPollingStatusType res = PQconnectPoll(conn);
+#define PG_CONNECT_TIMEOUT_MS 5000
 
-    u64 timeout_secs = 5;
-    u64 poll_count = 0;
-    u64 max_poll = timeout_secs * 100;
+// Drives a started connect or reset to completion. Never blocks in libpq:
+// polling only happens once the socket is ready for what libpq asked for, so
+// setup is as fast as the network and the timeout holds to the millisecond.
+internal b32
+pg_finish_connect(PGconn *c, b32 is_reset, u32 timeout_ms) {
+    f64 deadline = os_get_time() + timeout_ms / 1000.0;
 
-    while (res != PGRES_POLLING_OK && res != PGRES_POLLING_FAILED) {
-        poll_count += 1;
-        if (poll_count > max_poll) {
-            log_error("Connection timeout after {d} seconds", timeout_secs);
+    // Right after starting libpq waits to write, as if polling returned WRITING
+    PostgresPollingStatusType status = PGRES_POLLING_WRITING;
+    while (status != PGRES_POLLING_OK && status != PGRES_POLLING_FAILED) {
+        s32 remaining_ms = (s32)((deadline - os_get_time()) * 1000.0);
+        if (remaining_ms <= 0) {
+            log_error("Connection timeout after {d} ms", (int)timeout_ms);
             return 0;
         }
-        sleep(10);
-        res = PQconnectPoll(conn);
+        if (!pg_wait_socket(c, status == PGRES_POLLING_READING ? POLLIN : POLLOUT, remaining_ms)) {
+            break;
+        }
+        status = is_reset ? PQresetPoll(c) : PQconnectPoll(c);
+    }
+
+    if (status != PGRES_POLLING_OK) {
+        log_error("Connection failed: {s}", PQerrorMessage(c));
+        return 0;
     }
+    return 1;
+}
+
+internal DB_Conn *
+pg_connect(DB_Config config) {
+    Arena   *arena = arena_alloc();
+    DB_Conn *db_conn = push_struct_zero(arena, DB_Conn);
+    db_conn->arena = arena;
 
-    if (res == PGRES_POLLING_FAILED) {
-        log_error("Connection failed after {d} seconds", timeout_secs);
+    u32     timeout_ms = config.connect_timeout_ms ? config.connect_timeout_ms : PG_CONNECT_TIMEOUT_MS;
+    PGconn *conn = PQconnectStart(str_to_cstring(arena, config.connection_string));
+    if (!conn || PQstatus(conn) == CONNECTION_BAD) {
+        log_error("Could not connect to postgres db: {s}", conn ? PQerrorMessage(conn) : "out of memory");
+        PQfinish(conn);
+        arena_release(arena);
         return 0;
     }
+    if (!pg_finish_connect(conn, 0, timeout_ms)) {
+        PQfinish(conn);
+        arena_release(arena);
+        return 0;
+    }
+
     db_conn->handle = conn_to_handle(conn);
+    db_conn->connect_timeout_ms = timeout_ms;
+    db_conn->statement_arena = arena_alloc();
+    db_conn->statements = hash_table_create(db_conn->statement_arena, 64);
+    db_conn->statement_count = 0;
     return db_conn;
 }
 
@@ -53,10 +97,24 @@ internal void
 pg_disconnet(DB_Conn *conn) {
     if (conn) {
         PQfinish((PGconn *)conn->handle.ptr);
+        arena_release(conn->statement_arena);
         arena_release(conn->arena);
     }
 }
 
+internal b32
+pg_check_connection(DB_Conn *conn) {
+    PGconn *c = handle_to_conn(conn->handle);
+    if (PQstatus(c) == CONNECTION_OK) {
+        return 1;
+    }
+    // A new session has none of the old prepared statements, start over
+    arena_clear(conn->statement_arena);
+    conn->statements = hash_table_create(conn->statement_arena, 64);
+    conn->statement_count = 0;
+    return PQresetStart(c) && pg_finish_connect(c, 1, conn->connect_timeout_ms);
+}
+
 internal DB_Schema_List pg_get_all_schemas(DB_Conn *conn) {
     PROF_FUNCTION;
     PGconn        *c = handle_to_conn(conn->handle);
@@ -85,7 +143,6 @@ internal DB_Schema_List pg_get_all_schemas(DB_Conn *conn) {
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         log_error("Query Failed {s}\n", query);
         PQclear(res);
-        PQfinish(c);
         Prof_End();
         return list;
     }
@@ -125,147 +182,1255 @@ internal DB_Schema_List pg_get_all_schemas(DB_Conn *conn) {
     return list;
 }
 
+// Column info straight from pg_catalog, one row per column:
+// schema, table, then the fields pg_push_column_info reads. Foreign keys are
+// matched on the constraint's own columns, so equally named tables in other
+// schemas don't leak in, and carry the referenced table's schema.
+#define PG_COLUMN_INFO_SELECT                                                                        \
+    "SELECT "                                                                                        \
+    "    n.nspname, "                                                                                \
+    "    c.relname, "                                                                                \
+    "    a.attname, "                                                                                \
+    "    format_type(a.atttypid, a.atttypmod), "                                                     \
+    "    CASE WHEN a.attnotnull THEN 'NO' ELSE 'YES' END, "                                          \
+    "    COALESCE(pg_get_expr(d.adbin, d.adrelid), ''), "                                            \
+    "    CASE WHEN fk.table_name IS NOT NULL THEN 'YES' ELSE 'NO' END, "                             \
+    "    COALESCE(fk.table_name, ''), "                                                              \
+    "    COALESCE(fk.column_name, ''), "                                                             \
+    "    COALESCE(fk.schema_name, '') "                                                              \
+    "FROM pg_attribute a "                                                                           \
+    "JOIN pg_class c ON c.oid = a.attrelid "                                                         \
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "                                                 \
+    "LEFT JOIN pg_attrdef d ON d.adrelid = a.attrelid AND d.adnum = a.attnum "                       \
+    "LEFT JOIN LATERAL ( "                                                                           \
+    "    SELECT fn.nspname AS schema_name, fc.relname AS table_name, fa.attname AS column_name "     \
+    "    FROM pg_constraint k "                                                                      \
+    "    JOIN pg_class fc ON fc.oid = k.confrelid "                                                  \
+    "    JOIN pg_namespace fn ON fn.oid = fc.relnamespace "                                          \
+    "    JOIN pg_attribute fa ON fa.attrelid = k.confrelid "                                         \
+    "        AND fa.attnum = k.confkey[array_position(k.conkey, a.attnum)] "                         \
+    "    WHERE k.contype = 'f' AND k.conrelid = a.attrelid AND a.attnum = ANY (k.conkey) "           \
+    "    ORDER BY k.conname "                                                                        \
+    "    LIMIT 1 "                                                                                   \
+    ") fk ON true "                                                                                  \
+    "WHERE a.attnum > 0 AND NOT a.attisdropped "
+
+#define PG_COLUMN_INFO_FIRST_FIELD 2
+
+// Same text for the blocking and async paths. $1 is the schema, $2 the table name.
+static const char *pg_schema_info_query =
+    PG_COLUMN_INFO_SELECT
+    "AND n.nspname = $1 AND c.relname = $2 "
+    "ORDER BY a.attnum";
+
+// Only the tables in $1 and $2, schema and table names as parallel arrays
+static const char *pg_some_schema_info_query =
+    PG_COLUMN_INFO_SELECT
+    "AND (n.nspname, c.relname) IN (SELECT * FROM unnest($1::name[], $2::name[])) "
+    "ORDER BY n.nspname, c.relname, a.attnum";
+
+// Which of those tables exist, with columns or without
+static const char *pg_some_tables_query =
+    "SELECT n.nspname, c.relname "
+    "FROM pg_class c "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "WHERE (n.nspname, c.relname) IN (SELECT * FROM unnest($1::name[], $2::name[]))";
+
+// Every table pg_get_all_schemas lists, in one round trip
+static const char *pg_all_schema_info_query =
+    PG_COLUMN_INFO_SELECT
+    "AND c.relkind IN ('r', 'p') "
+    "AND n.nspname NOT IN ('pg_catalog', 'information_schema') "
+    "ORDER BY n.nspname, c.relname, a.attnum";
+
+internal DB_Table *
+pg_table_alloc(DB_Schema schema) {
+    return db_table_alloc(schema);
+}
+
+// Appends the column described by row r of res, the fields start at first_field
+internal void
+pg_push_column_info(DB_Table *table, PGresult *res, s32 r, s32 first_field) {
+    Arena          *arena = table->arena;
+    DB_Column_Info *col = dyn_array_push(arena, &table->columns, DB_Column_Info);
+    if (!col) {
+        log_error("Failed to allocate column info");
+        return;
+    }
+    table->column_count++;
+
+    char *col_name = PQgetvalue(res, r, first_field + 0);
+    char *data_type = PQgetvalue(res, r, first_field + 1);
+    char *nullable = PQgetvalue(res, r, first_field + 2);
+    char *default_val = PQgetvalue(res, r, first_field + 3);
+    char *is_fk = PQgetvalue(res, r, first_field + 4);
+    char *fk_table = PQgetvalue(res, r, first_field + 5);
+    char *fk_column = PQgetvalue(res, r, first_field + 6);
+    char *fk_schema = PQgetvalue(res, r, first_field + 7);
+
+    *col = (DB_Column_Info){0};
+
+    col->column_name = str_push_copy(arena, cstr_to_string(col_name, strlen(col_name)));
+    col->data_type = str_push_copy(arena, cstr_to_string(data_type, strlen(data_type)));
+    col->is_nullable = str_push_copy(arena, cstr_to_string(nullable, strlen(nullable)));
+    col->column_default = str_push_copy(arena, cstr_to_string(default_val, strlen(default_val)));
+    col->is_foreign_key = str_push_copy(arena, cstr_to_string(is_fk, strlen(is_fk)));
+    col->foreign_schema_name = str_push_copy(arena, cstr_to_string(fk_schema, strlen(fk_schema)));
+    col->foreign_table_name = str_push_copy(arena, cstr_to_string(fk_table, strlen(fk_table)));
+    col->foreign_column_name = str_push_copy(arena, cstr_to_string(fk_column, strlen(fk_column)));
+
+    char display_buf[512];
+    snprintf(display_buf, sizeof(display_buf), "%s: %s", col_name, data_type);
+    u64 display_len = strlen(display_buf);
+    col->display_text = push_array(arena, char, display_len + 1);
+    MemoryCopy(col->display_text, display_buf, display_len + 1);
+
+    col->is_fk = (strcmp(is_fk, "YES") == 0);
+
+    if (col->is_fk) {
+        char fk_buf[256];
+        snprintf(fk_buf, sizeof(fk_buf), "  → %s", fk_table);
+        u64 fk_len = strlen(fk_buf);
+        col->fk_display = push_array(arena, char, fk_len + 1);
+        MemoryCopy(col->fk_display, fk_buf, fk_len + 1);
+    } else {
+        col->fk_display = NULL;
+    }
+}
+
+internal DB_Table *
+pg_table_from_schema_info(PGresult *res, DB_Schema schema) {
+    DB_Table *table = pg_table_alloc(schema);
+
+    s32 n_rows = PQntuples(res);
+    for (s32 r = 0; r < n_rows; r++) {
+        pg_push_column_info(table, res, r, PG_COLUMN_INFO_FIRST_FIELD);
+    }
+    return table;
+}
+
+// Splits the all tables result into one table per entry of schemas. Rows come
+// sorted by schema and table, so each table is one run of rows. The name index
+// is built in a scratch on arena.
+internal void
+pg_tables_from_all_schema_info(Arena *arena, PGresult *res, DB_Schema *schemas, u64 count, DB_Table **tables) {
+    Scratch     scratch = scratch_begin(arena);
+    Hash_Table *index_by_name = hash_table_create(scratch.arena, count * 2 + 1);
+
+    for (u64 i = 0; i < count; i++) {
+        String key = db_schema_key(scratch.arena, schemas[i].schema, schemas[i].name);
+        hash_table_push_string_u64(scratch.arena, index_by_name, key, i);
+    }
+
+    s32       n_rows = PQntuples(res);
+    DB_Table *table = 0;
+    for (s32 r = 0; r < n_rows; r++) {
+        char *schema_name = PQgetvalue(res, r, 0);
+        char *table_name = PQgetvalue(res, r, 1);
+        b32   same_table = r > 0 && strcmp(schema_name, PQgetvalue(res, r - 1, 0)) == 0 &&
+                         strcmp(table_name, PQgetvalue(res, r - 1, 1)) == 0;
+        if (!same_table) {
+            String          key = db_schema_key(scratch.arena, cstr_to_string(schema_name, strlen(schema_name)),
+                                                cstr_to_string(table_name, strlen(table_name)));
+            Key_Value_Pair *kv = hash_table_search_string(index_by_name, key);
+            table = 0;
+            if (kv && !tables[kv->value_u64]) {
+                table = pg_table_alloc(schemas[kv->value_u64]);
+                tables[kv->value_u64] = table;
+            }
+        }
+        if (table) {
+            pg_push_column_info(table, res, r, PG_COLUMN_INFO_FIRST_FIELD);
+        }
+    }
+    scratch_end(&scratch);
+}
+
+// Type oids from pg_type.dat, stable across server versions
+#define PG_OID_BOOL        16
+#define PG_OID_CHAR        18
+#define PG_OID_NAME        19
+#define PG_OID_INT8        20
+#define PG_OID_INT2        21
+#define PG_OID_INT4        23
+#define PG_OID_TEXT        25
+#define PG_OID_JSON        114
+#define PG_OID_XML         142
+#define PG_OID_FLOAT4      700
+#define PG_OID_FLOAT8      701
+#define PG_OID_UNKNOWN     705
+#define PG_OID_BPCHAR      1042
+#define PG_OID_VARCHAR     1043
+#define PG_OID_DATE        1082
+#define PG_OID_TIMESTAMP   1114
+#define PG_OID_TIMESTAMPTZ 1184
+#define PG_OID_NUMERIC     1700
+#define PG_OID_UUID        2950
+#define PG_OID_JSONB       3802
+
+// Column type for a binary format result column
+internal DB_Column_Type
+pg_column_type_from_oid(Oid oid) {
+    switch (oid) {
+    case PG_OID_BOOL:
+        return DB_COLUMN_BOOL;
+    case PG_OID_INT2:
+        return DB_COLUMN_INT16;
+    case PG_OID_INT4:
+        return DB_COLUMN_INT32;
+    case PG_OID_INT8:
+        return DB_COLUMN_INT64;
+    case PG_OID_FLOAT4:
+        return DB_COLUMN_FLOAT32;
+    case PG_OID_FLOAT8:
+        return DB_COLUMN_FLOAT64;
+    case PG_OID_NUMERIC:
+        return DB_COLUMN_NUMERIC;
+    case PG_OID_DATE:
+        return DB_COLUMN_DATE;
+    case PG_OID_TIMESTAMP:
+        return DB_COLUMN_TIMESTAMP;
+    case PG_OID_TIMESTAMPTZ:
+        return DB_COLUMN_TIMESTAMPTZ;
+    case PG_OID_UUID:
+        return DB_COLUMN_UUID;
+    case PG_OID_CHAR:
+    case PG_OID_NAME:
+    case PG_OID_TEXT:
+    case PG_OID_JSON:
+    case PG_OID_XML:
+    case PG_OID_UNKNOWN:
+    case PG_OID_BPCHAR:
+    case PG_OID_VARCHAR:
+    case PG_OID_JSONB:
+        // Binary send of these is the text itself
+        return DB_COLUMN_TEXT;
+    default:
+        return DB_COLUMN_BYTES;
+    }
+}
+
+internal void
+pg_table_columns_from_result(DB_Table *table, PGresult *res) {
+    Arena *arena = table->arena;
+    table->column_count = PQnfields(res);
+
+    for (u64 c = 0; c < table->column_count; c++) {
+        DB_Column_Info *col = dyn_array_push(arena, &table->columns, DB_Column_Info);
+        const char     *col_name = PQfname(res, (int)c);
+        col->column_name = str_push_copy(arena, cstr_to_string(col_name, strlen(col_name)));
+
+        col->display_text = push_array(arena, char, strlen(col_name) + 1);
+        MemoryCopy(col->display_text, col_name, strlen(col_name) + 1);
+        col->is_fk = false;
+        col->fk_display = NULL;
+        col->is_truncated = 0;
+        col->type_modifier = (u32)PQfmod(res, (int)c);
+        col->type = PQfformat(res, (int)c) ? pg_column_type_from_oid(PQftype(res, (int)c)) : DB_COLUMN_TEXT;
+    }
+}
+
+// Big endian wire values to host order
+internal u16
+pg_read_u16(u8 *p) {
+    return (u16)((p[0] << 8) | p[1]);
+}
+
+internal u32
+pg_read_u32(u8 *p) {
+    return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | (u32)p[3];
+}
+
+internal u64
+pg_read_u64(u8 *p) {
+    return ((u64)pg_read_u32(p) << 32) | (u64)pg_read_u32(p + 4);
+}
+
+// Binary numeric: ndigits, weight, sign, dscale, then base 10000 digits
+#define PG_NUMERIC_NEG  0x4000
+#define PG_NUMERIC_NAN  0xC000
+#define PG_NUMERIC_PINF 0xD000
+#define PG_NUMERIC_NINF 0xF000
+
+internal f64
+pg_numeric_to_f64(u8 *p, u32 size) {
+    if (size < 8)
+        return 0.0;
+
+    u16 ndigits = pg_read_u16(p);
+    s16 weight = (s16)pg_read_u16(p + 2);
+    u16 sign = pg_read_u16(p + 4);
+    if (sign == PG_NUMERIC_NAN)
+        return NAN;
+    if (sign == PG_NUMERIC_PINF)
+        return INFINITY;
+    if (sign == PG_NUMERIC_NINF)
+        return -INFINITY;
+
+    f64 result = 0.0;
+    for (u16 i = 0; i < ndigits && 8 + (u32)i * 2 + 2 <= size; i++) {
+        result += (f64)pg_read_u16(p + 8 + i * 2) * pow(10000.0, (f64)(weight - i));
+    }
+    return sign == PG_NUMERIC_NEG ? -result : result;
+}
+
+// Exact text like numeric_out: every integer digit, then dscale fraction digits
+internal String
+pg_numeric_to_text(Arena *arena, u8 *p, u32 size) {
+    if (size < 8)
+        return str_zero();
+
+    u16 ndigits = pg_read_u16(p);
+    s16 weight = (s16)pg_read_u16(p + 2);
+    u16 sign = pg_read_u16(p + 4);
+    u16 dscale = pg_read_u16(p + 6) & 0x3FFF;
+    if (sign == PG_NUMERIC_NAN)
+        return str_lit("NaN");
+    if (sign == PG_NUMERIC_PINF)
+        return str_lit("Infinity");
+    if (sign == PG_NUMERIC_NINF)
+        return str_lit("-Infinity");
+    ndigits = (u16)Min(ndigits, (size - 8) / 2);
+
+    u64 int_groups = weight >= 0 ? (u64)weight + 1 : 1;
+    u8 *text = push_array(arena, u8, 1 + int_groups * 4 + 1 + dscale + 4);
+    u64 len = 0;
+    if (sign == PG_NUMERIC_NEG) {
+        text[len++] = '-';
+    }
+
+    // Digit group d is worth 10000^(weight - d)
+    if (weight < 0) {
+        text[len++] = '0';
+    }
+    for (s32 d = 0; d <= weight; d++) {
+        u16 digit = d < ndigits ? pg_read_u16(p + 8 + d * 2) : 0;
+        u16 div[4] = {1000, 100, 10, 1};
+        for (u32 k = 0; k < 4; k++) {
+            u8 ch = (u8)('0' + digit / div[k] % 10);
+            // Leading zeros of the first group are dropped, a lone zero is kept
+            if (d > 0 || len > (sign == PG_NUMERIC_NEG) || ch != '0' || k == 3) {
+                text[len++] = ch;
+            }
+        }
+    }
+
+    if (dscale > 0) {
+        text[len++] = '.';
+        u64 end = len + dscale;
+        for (s32 d = weight + 1; len < end; d++) {
+            u16 digit = d >= 0 && d < ndigits ? pg_read_u16(p + 8 + d * 2) : 0;
+            u16 div[4] = {1000, 100, 10, 1};
+            for (u32 k = 0; k < 4 && len < end; k++) {
+                text[len++] = (u8)('0' + digit / div[k] % 10);
+            }
+        }
+    }
+    return str(text, len);
+}
+
+// Decodes one binary cell into the host order value db_page_cell_format expects.
+// Numeric is the f64 for sorting and filtering followed by its exact text, in arena.
+internal String
+pg_decode_binary_cell(Arena *arena, DB_Column_Type type, String value, u8 *buf) {
+    switch (type) {
+    case DB_COLUMN_INT16: {
+        u16 x = pg_read_u16(value.data);
+        MemoryCopy(buf, &x, 2);
+        return str(buf, 2);
+    } break;
+    case DB_COLUMN_INT32:
+    case DB_COLUMN_FLOAT32:
+    case DB_COLUMN_DATE: {
+        u32 x = pg_read_u32(value.data);
+        MemoryCopy(buf, &x, 4);
+        return str(buf, 4);
+    } break;
+    case DB_COLUMN_INT64:
+    case DB_COLUMN_FLOAT64:
+    case DB_COLUMN_TIMESTAMP:
+    case DB_COLUMN_TIMESTAMPTZ: {
+        u64 x = pg_read_u64(value.data);
+        MemoryCopy(buf, &x, 8);
+        return str(buf, 8);
+    } break;
+    case DB_COLUMN_NUMERIC: {
+        f64    x = pg_numeric_to_f64(value.data, value.size);
+        String text = pg_numeric_to_text(arena, value.data, value.size);
+        u8    *cell = push_array(arena, u8, 8 + text.size);
+        MemoryCopy(cell, &x, 8);
+        MemoryCopy(cell + 8, text.data, text.size);
+        return str(cell, 8 + text.size);
+    } break;
+    default:
+        // bool and uuid are already in display order
+        return value;
+    }
+}
+
+// Appends every row of res, returns the new total. Rows are not published.
+// Zero copy tables reference res for text and bytes cells, so the caller has to
+// hand it to db_table_retain instead of clearing it. Decoded numeric text goes
+// to a scratch on arena, workers have no thread context to take one from.
+internal u64
+pg_table_append_rows(Arena *arena, DB_Table *table, PGresult *res, u64 row_count) {
+    s32     n_rows = PQntuples(res);
+    Scratch scratch = scratch_begin(arena);
+
+    for (s32 r = 0; r < n_rows; r++) {
+        db_table_push_row(table);
+        for (u64 c = 0; c < table->column_count; c++) {
+            DB_Column_Info *col = dyn_array_get(&table->columns, DB_Column_Info, c);
+            String          value = str((u8 *)PQgetvalue(res, r, (int)c), PQgetlength(res, r, (int)c));
+            b32             is_null = PQgetisnull(res, r, (int)c);
+            b32             is_blob = col->type == DB_COLUMN_TEXT || col->type == DB_COLUMN_BYTES;
+            u8              buf[8];
+
+            if (is_null) {
+                value.size = 0;
+            } else if (col->type == DB_COLUMN_TEXT && PQfformat(res, (int)c) && PQftype(res, (int)c) == PG_OID_JSONB && value.size) {
+                // Binary jsonb is its text form behind a version byte
+                value = str(value.data + 1, value.size - 1);
+            } else if (col->type == DB_COLUMN_NUMERIC || value.size == db_column_type_size(col->type)) {
+                value = pg_decode_binary_cell(scratch.arena, col->type, value, buf);
+            }
+
+            if (table->zero_copy && is_blob) {
+                db_table_push_cell_ref(table, c, value, is_null);
+            } else {
+                db_table_push_cell(table, c, value, is_null);
+            }
+        }
+
+        if (table->projection.wide_count) {
+            // Whole sizes of the cut values, then the locator, come after the shown columns
+            s32 field = (s32)table->column_count;
+            for (u32 w = 0; w < table->projection.wide_count; w++, field++) {
+                u64 size = PQgetisnull(res, r, field) ? 0 : strtoull(PQgetvalue(res, r, field), 0, 10);
+                db_table_set_full_size(table, table->projection.wide_columns[w], size);
+            }
+            db_table_set_locator(table, str((u8 *)PQgetvalue(res, r, field), PQgetlength(res, r, field)));
+        }
+        scratch_end(&scratch);
+    }
+    return row_count + (u64)n_rows;
+}
+
+internal void
+pg_result_release(DB_Handle handle) {
+    PQclear((PGresult *)handle.ptr);
+}
+
+// Takes ownership of res
+internal DB_Table *
+pg_table_from_data(Arena *arena, PGresult *res, DB_Schema schema, b32 zero_copy) {
+    DB_Table *table = pg_table_alloc(schema);
+    table->zero_copy = zero_copy;
+    pg_table_columns_from_result(table, res);
+    db_table_publish_rows(table, pg_table_append_rows(arena, table, res, 0));
+    if (zero_copy) {
+        db_table_retain(table, DB_KIND_POSTGRES, (DB_Handle){.ptr = res});
+    } else {
+        PQclear(res);
+    }
+    return table;
+}
+
+// schema.name with both parts quoted, so table names can't inject SQL. Null if
+// quoting failed.
+internal char *
+pg_quote_table(Arena *arena, PGconn *c, DB_Schema schema) {
+    char *schema_ident = schema.schema.size ? PQescapeIdentifier(c, (char *)schema.schema.data, schema.schema.size) : 0;
+    char *name_ident = PQescapeIdentifier(c, (char *)schema.name.data, schema.name.size);
+    char *result = 0;
+
+    if (name_ident && (schema_ident || !schema.schema.size)) {
+        u64 size = strlen(name_ident) + (schema_ident ? strlen(schema_ident) : 0) + 2;
+        result = push_array(arena, char, size);
+        snprintf(result, size, "%s%s%s", schema_ident ? schema_ident : "", schema_ident ? "." : "", name_ident);
+    } else {
+        log_error("Failed to quote table name: {s}", PQerrorMessage(c));
+    }
+
+    if (schema_ident) {
+        PQfreemem(schema_ident);
+    }
+    if (name_ident) {
+        PQfreemem(name_ident);
+    }
+    return result;
+}
+
+// What a data query selects, * without a projection
+internal const char *
+pg_select_list(Arena *arena, DB_Projection *projection) {
+    return projection->select_list.size ? str_to_cstring(arena, projection->select_list) : "*";
+}
+
+// $1 is the row limit, $2 the percent sampled if there is a method. Only
+// tables take TABLESAMPLE, anything else is filtered row by row.
+internal char *
+pg_data_query(Arena *arena, PGconn *c, DB_Schema schema, const char *select, DB_Sample_Method method) {
+    char *table = pg_quote_table(arena, c, schema);
+    if (!table)
+        return 0;
+    const char *sample = "";
+    if (method != DB_SAMPLE_NONE && schema.kind != DB_SCHEMA_KIND_TABLE) {
+        sample = " WHERE random() * 100 < $2::float8";
+    } else if (method == DB_SAMPLE_SYSTEM) {
+        sample = " TABLESAMPLE SYSTEM ($2::float4)";
+    } else if (method == DB_SAMPLE_BERNOULLI) {
+        sample = " TABLESAMPLE BERNOULLI ($2::float4)";
+    }
+    u64   size = strlen(select) + strlen(table) + strlen(sample) + 32;
+    char *query = push_array(arena, char, size);
+    snprintf(query, size, "SELECT %s FROM %s%s LIMIT $1", select, table, sample);
+    return query;
+}
+
+// SELECT *, key::text FROM t WHERE (key) > ($2, ...) ORDER BY key LIMIT $1.
+// The row comparison seeks in the primary key index instead of skipping rows,
+// the trailing key columns give the start of the next page. Without a key
+// it's OFFSET $2, which rescans everything before the page. select replaces
+// the * with a projection.
+internal char *
+pg_page_query(Arena *arena, PGconn *c, DB_Schema schema, const char *select, DB_Page_Key *key) {
+    char *table = pg_quote_table(arena, c, schema);
+    if (!table)
+        return 0;
+
+    if (key->column_count == 0) {
+        u64   size = strlen(select) + strlen(table) + 48;
+        char *query = push_array(arena, char, size);
+        snprintf(query, size, "SELECT %s FROM %s OFFSET $2 LIMIT $1", select, table);
+        return query;
+    }
+
+    const char *idents[DB_PAGE_KEY_MAX];
+    u64         size = strlen(select) + strlen(table) + 64;
+    for (u32 k = 0; k < key->column_count; k++) {
+        char *ident = PQescapeIdentifier(c, (char *)key->columns[k].data, key->columns[k].size);
+        if (!ident) {
+            log_error("Failed to quote key column: {s}", PQerrorMessage(c));
+            return 0;
+        }
+        idents[k] = str_to_cstring(arena, cstr_to_string(ident, strlen(ident)));
+        PQfreemem(ident);
+        size += strlen(idents[k]) * 3 + 32;
+    }
+
+    char *query = push_array(arena, char, size);
+    u64   at = 0;
+    at += snprintf(query + at, size - at, "SELECT %s", select);
+    for (u32 k = 0; k < key->column_count; k++) {
+        at += snprintf(query + at, size - at, ", %s::text", idents[k]);
+    }
+    at += snprintf(query + at, size - at, " FROM %s", table);
+    if (key->has_values) {
+        at += snprintf(query + at, size - at, " WHERE (");
+        for (u32 k = 0; k < key->column_count; k++) {
+            at += snprintf(query + at, size - at, "%s%s", k ? ", " : "", idents[k]);
+        }
+        at += snprintf(query + at, size - at, ") > (");
+        for (u32 k = 0; k < key->column_count; k++) {
+            at += snprintf(query + at, size - at, "%s$%u", k ? ", " : "", k + 2);
+        }
+        at += snprintf(query + at, size - at, ")");
+    }
+    at += snprintf(query + at, size - at, " ORDER BY ");
+    for (u32 k = 0; k < key->column_count; k++) {
+        at += snprintf(query + at, size - at, "%s%s", k ? ", " : "", idents[k]);
+    }
+    snprintf(query + at, size - at, " LIMIT $1");
+    return query;
+}
+
+// One whole value for DB_REQUEST_CELL_VALUE. A row updated since it was
+// fetched has moved to a new ctid and comes back empty.
+internal char *
+pg_cell_query(Arena *arena, PGconn *c, DB_Schema schema, String column) {
+    char *table = pg_quote_table(arena, c, schema);
+    char *ident = PQescapeIdentifier(c, (char *)column.data, column.size);
+    char *query = 0;
+    if (table && ident) {
+        u64 size = strlen(ident) + strlen(table) + 64;
+        query = push_array(arena, char, size);
+        snprintf(query, size, "SELECT %s FROM %s WHERE tableoid = $1::oid AND ctid = $2::tid", ident, table);
+    } else if (!ident) {
+        log_error("Failed to quote column name: {s}", PQerrorMessage(c));
+    }
+    if (ident) {
+        PQfreemem(ident);
+    }
+    return query;
+}
+
+// reltuples as of the last VACUUM or ANALYZE, -1 if there was none. A
+// partitioned table has no rows of its own, its partitions are summed.
+static const char *pg_row_estimates_query =
+    "SELECT n.nspname, c.relname, "
+    "    CASE WHEN c.relkind = 'p' THEN ( "
+    "        SELECT sum(p.reltuples)::bigint FROM pg_inherits i "
+    "        JOIN pg_class p ON p.oid = i.inhrelid "
+    "        WHERE i.inhparent = c.oid AND p.reltuples >= 0 "
+    "    ) WHEN c.reltuples >= 0 THEN c.reltuples::bigint END "
+    "FROM pg_class c "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "WHERE c.relkind IN ('r', 'p') "
+    "AND n.nspname NOT IN ('pg_catalog', 'information_schema')";
+
+// Statement text with its parameters, run prepared where possible
+typedef struct PG_Query PG_Query;
+struct PG_Query {
+    const char *text; // Null if the query couldn't be built
+    const char *params[DB_PAGE_KEY_MAX + 1]; // Limit plus key values for pages
+    s32         param_count;
+    s32         result_format;
+};
+
+internal PG_Query
+pg_request_query(Arena *arena, PGconn *c, DB_Request *request) {
+    PG_Query query = {0};
+    switch (request->kind) {
+    case DB_REQUEST_SCHEMA_INFO: {
+        query.text = pg_schema_info_query;
+        query.params[0] = str_to_cstring(arena, request->schema.schema);
+        query.params[1] = str_to_cstring(arena, request->schema.name);
+        query.param_count = 2;
+    } break;
+    case DB_REQUEST_TABLE_DATA: {
+        char *limit = push_array(arena, char, 16);
+        snprintf(limit, 16, "%u", request->limit);
+        query.text = pg_data_query(arena, c, request->schema, pg_select_list(arena, &request->projection), request->sample_method);
+        query.params[0] = limit;
+        query.param_count = 1;
+        if (request->sample_method != DB_SAMPLE_NONE) {
+            char *percent = push_array(arena, char, 32);
+            snprintf(percent, 32, "%g", Clamp(0.0f, request->sample_percent, 100.0f));
+            query.params[1] = percent;
+            query.param_count = 2;
+        }
+        // resultFormat applies to every column, unknown types come back as raw bytes
+        query.result_format = request->binary ? 1 : 0;
+    } break;
+    case DB_REQUEST_TABLE_PAGE: {
+        // The key and projection are resolved by pg_run_requests before this
+        DB_Page_Key *key = &request->after;
+        query.text = pg_page_query(arena, c, request->schema, pg_select_list(arena, &request->projection), key);
+        query.params[0] = push_array(arena, char, 16);
+        snprintf((char *)query.params[0], 16, "%u", request->limit);
+        query.param_count = 1;
+        if (key->column_count == 0) {
+            query.params[1] = push_array(arena, char, 24);
+            snprintf((char *)query.params[1], 24, "%llu", (unsigned long long)key->offset);
+            query.param_count = 2;
+        } else if (key->has_values) {
+            // Sent untyped, the server reads them as the key columns' own types
+            for (u32 k = 0; k < key->column_count; k++) {
+                query.params[k + 1] = str_to_cstring(arena, key->values[k]);
+            }
+            query.param_count = 1 + (s32)key->column_count;
+        }
+        query.result_format = request->binary ? 1 : 0;
+    } break;
+    case DB_REQUEST_EXPORT:
+    case DB_REQUEST_IMPORT: {
+        // COPY streams over its own protocol, run by the worker itself through db_export/db_import
+    } break;
+    case DB_REQUEST_CATALOG: {
+        // Several blocking queries, run by the worker itself through db_catalog_refresh
+    } break;
+    case DB_REQUEST_SCHEMA_CHANGE: {
+        // Posted by the DDL listener, never queued
+    } break;
+    case DB_REQUEST_ROW_ESTIMATES: {
+        query.text = pg_row_estimates_query;
+    } break;
+    case DB_REQUEST_CELL_VALUE: {
+        // The locator is "tableoid ctid"
+        String locator = request->cell_locator;
+        u64    space = 0;
+        while (space < locator.size && locator.data[space] != ' ') {
+            space++;
+        }
+        query.text = pg_cell_query(arena, c, request->schema, request->cell_column);
+        query.params[0] = str_to_cstring(arena, str(locator.data, space));
+        query.params[1] = str_to_cstring(arena, str(locator.data + Min(space + 1, locator.size), locator.size - Min(space + 1, locator.size)));
+        query.param_count = 2;
+    } break;
+    }
+    return query;
+}
+
+// Past this many the rest run unnamed, every data query text is its own statement
+#define PG_STATEMENT_CACHE_CAP 256
+
+// Name of the prepared statement for text, prepared on first use so the server
+// only parses and plans it once per connection. Null if it isn't prepared and
+// can't be right now (pipeline mode, full cache, prepare failed).
+internal char *
+pg_statement_name(Arena *arena, DB_Conn *conn, const char *text, s32 param_count) {
+    PGconn         *c = handle_to_conn(conn->handle);
+    String          key = cstr_to_string(text, strlen(text));
+    Key_Value_Pair *kv = hash_table_search_string(conn->statements, key);
+    u64             id = 0;
+
+    if (kv) {
+        id = kv->value_u64;
+    } else {
+        if (conn->statement_count >= PG_STATEMENT_CACHE_CAP)
+            return 0;
+#ifdef LIBPQ_HAS_PIPELINING
+        // Preparing is a blocking round trip, not allowed while a pipeline is open
+        if (PQpipelineStatus(c) != PQ_PIPELINE_OFF)
+            return 0;
+#endif
+        id = conn->statement_count + 1;
+        char name[32];
+        snprintf(name, sizeof(name), "dbui_%llu", (unsigned long long)id);
+
+        PGresult *res = PQprepare(c, name, text, param_count, NULL);
+        b32       prepared = PQresultStatus(res) == PGRES_COMMAND_OK;
+        if (!prepared) {
+            log_error("Failed to prepare statement: {s}", PQresultErrorMessage(res));
+        }
+        PQclear(res);
+        if (!prepared)
+            return 0;
+
+        conn->statement_count = id;
+        hash_table_push_string_u64(conn->statement_arena, conn->statements, str_push_copy(conn->statement_arena, key), id);
+    }
+
+    char *name = push_array(arena, char, 32);
+    snprintf(name, 32, "dbui_%llu", (unsigned long long)id);
+    return name;
+}
+
+internal PGresult *
+pg_exec_query(DB_Conn *conn, PG_Query *query) {
+    PGconn *c = handle_to_conn(conn->handle);
+    Scratch scratch = scratch_begin(conn->arena);
+    char   *statement = pg_statement_name(scratch.arena, conn, query->text, query->param_count);
+
+    PGresult *res = 0;
+    if (statement) {
+        res = PQexecPrepared(c, statement, query->param_count, query->params, NULL, NULL, query->result_format);
+    } else {
+        res = PQexecParams(c, query->text, query->param_count, NULL, query->params, NULL, NULL, query->result_format);
+    }
+    scratch_end(&scratch);
+    return res;
+}
+
+internal b32
+pg_send_query(DB_Conn *conn, PG_Query *query) {
+    PGconn *c = handle_to_conn(conn->handle);
+    Scratch scratch = scratch_begin(conn->arena);
+    char   *statement = pg_statement_name(scratch.arena, conn, query->text, query->param_count);
+
+    b32 sent = 0;
+    if (statement) {
+        sent = PQsendQueryPrepared(c, statement, query->param_count, query->params, NULL, NULL, query->result_format);
+    } else {
+        sent = PQsendQueryParams(c, query->text, query->param_count, NULL, query->params, NULL, NULL, query->result_format);
+    }
+    scratch_end(&scratch);
+    return sent;
+}
+
 internal DB_Table *pg_get_schema_info(DB_Conn *conn, DB_Schema schema) {
     PROF_FUNCTION;
     PGconn *c = handle_to_conn(conn->handle);
 
-    Arena    *arena = arena_alloc();
-    DB_Table *table = push_struct_zero(arena, DB_Table);
-    table->arena = arena;
-    table->schema = schema;
-
-    table->columns = (Dyn_Array){0};
-    table->rows = (Dyn_Array){0};
-
-    char        query_buffer[4096];
-    const char *schema_name_cstr = str_to_cstring(arena, schema.schema);
-    const char *table_name_cstr = str_to_cstring(arena, schema.name);
-
-    snprintf(query_buffer, sizeof(query_buffer),
-             "SELECT "
-             "    c.column_name, "
-             "    c.data_type, "
-             "    c.is_nullable, "
-             "    c.column_default, "
-             "    CASE WHEN fk.column_name IS NOT NULL THEN 'YES' ELSE 'NO' END AS is_foreign_key, "
-             "    COALESCE(fk.foreign_table_name, '') AS foreign_table_name, "
-             "    COALESCE(fk.foreign_column_name, '') AS foreign_column_name "
-             "FROM information_schema.columns c "
-             "LEFT JOIN ( "
-             "    SELECT "
-             "        kcu.column_name, "
-             "        ccu.table_name AS foreign_table_name, "
-             "        ccu.column_name AS foreign_column_name "
-             "    FROM information_schema.table_constraints tc "
-             "    JOIN information_schema.key_column_usage kcu "
-             "        ON tc.constraint_name = kcu.constraint_name "
-             "        AND tc.table_schema = kcu.table_schema "
-             "    JOIN information_schema.constraint_column_usage ccu "
-             "        ON ccu.constraint_name = tc.constraint_name "
-             "        AND ccu.table_schema = tc.table_schema "
-             "    WHERE tc.constraint_type = 'FOREIGN KEY' "
-             "        AND tc.table_name = '%s' "
-             ") fk ON c.column_name = fk.column_name "
-             "WHERE c.table_name = '%s' "
-             "ORDER BY c.ordinal_position",
-             table_name_cstr, table_name_cstr);
-
-    PGresult *res = PQexec(c, query_buffer);
+    Scratch  scratch = scratch_begin(conn->arena);
+    PG_Query query = {pg_schema_info_query, {str_to_cstring(scratch.arena, schema.schema), str_to_cstring(scratch.arena, schema.name)}, 2, 0};
+    PGresult *res = pg_exec_query(conn, &query);
+    scratch_end(&scratch);
 
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         const char *error_msg = PQerrorMessage(c);
         log_error("Failed to get schema info: {s}", error_msg);
         PQclear(res);
-        arena_release(arena);
         Prof_End();
         return 0;
     }
 
-    s32 n_rows = PQntuples(res);
-    table->column_count = n_rows;
+    DB_Table *table = pg_table_from_schema_info(res, schema);
+    PQclear(res);
+    Prof_End();
+    return table;
+}
 
-    for (s32 r = 0; r < n_rows; r++) {
-        DB_Column_Info *col = dyn_array_push(arena, &table->columns, DB_Column_Info);
-        if (!col) {
-            log_error("Failed to allocate column info");
-            continue;
+// Cheap summary of everything the catalog is built from: the xmin of a catalog
+// row changes whenever the row is rewritten, so any DDL on a user table, column,
+// default, foreign key or function changes one of the hashes.
+static const char *pg_catalog_fingerprint_query =
+    "WITH rels AS ( "
+    "    SELECT c.oid, c.xmin FROM pg_class c "
+    "    JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "    WHERE c.relkind IN ('r', 'p') AND n.nspname NOT IN ('pg_catalog', 'information_schema') "
+    ") "
+    "SELECT "
+    "    md5(COALESCE((SELECT string_agg(oid::text || ':' || xmin::text, ',' ORDER BY oid) FROM rels), '')) || "
+    "    md5(COALESCE((SELECT string_agg(a.attrelid::text || '.' || a.attnum::text || ':' || a.xmin::text, ',' "
+    "                  ORDER BY a.attrelid, a.attnum) "
+    "                  FROM pg_attribute a JOIN rels r ON r.oid = a.attrelid WHERE a.attnum > 0), '')) || "
+    "    md5(COALESCE((SELECT string_agg(d.oid::text || ':' || d.xmin::text, ',' ORDER BY d.oid) "
+    "                  FROM pg_attrdef d JOIN rels r ON r.oid = d.adrelid), '')) || "
+    "    md5(COALESCE((SELECT string_agg(k.oid::text || ':' || k.xmin::text, ',' ORDER BY k.oid) "
+    "                  FROM pg_constraint k JOIN rels r ON r.oid = k.conrelid WHERE k.contype = 'f'), '')) || "
+    "    md5(COALESCE((SELECT string_agg(p.oid::text || ':' || p.xmin::text, ',' ORDER BY p.oid) "
+    "                  FROM pg_proc p JOIN pg_namespace n ON n.oid = p.pronamespace "
+    "                  WHERE n.nspname NOT IN ('pg_catalog', 'information_schema')), ''))";
+
+// 0 if the query failed
+internal u64
+pg_get_catalog_fingerprint(DB_Conn *conn) {
+    PROF_FUNCTION;
+    PGconn   *c = handle_to_conn(conn->handle);
+    PGresult *res = PQexecParams(c, pg_catalog_fingerprint_query, 0, NULL, NULL, NULL, NULL, 0);
+    u64       fingerprint = 0;
+
+    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) == 1) {
+        fingerprint = XXH3_64bits(PQgetvalue(res, 0, 0), PQgetlength(res, 0, 0));
+        fingerprint = Max(fingerprint, 1);
+    } else {
+        log_error("Failed to fingerprint catalog: {s}", PQerrorMessage(c));
+    }
+    PQclear(res);
+    Prof_End();
+    return fingerprint;
+}
+
+// Column info for every entry of schemas in one query. tables[i] stays null for
+// entries the catalog doesn't know. Returns 0 if the query failed.
+internal b32
+pg_get_all_schema_info(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables) {
+    PROF_FUNCTION;
+    PGconn   *c = handle_to_conn(conn->handle);
+    PGresult *res = PQexecParams(c, pg_all_schema_info_query, 0, NULL, NULL, NULL, NULL, 0);
+
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        const char *error_msg = PQerrorMessage(c);
+        log_error("Failed to get schema info: {s}", error_msg);
+        PQclear(res);
+        Prof_End();
+        return 0;
+    }
+
+    pg_tables_from_all_schema_info(conn->arena, res, schemas, count, tables);
+    PQclear(res);
+    Prof_End();
+    return 1;
+}
+
+// {"a","b"}, quotes and backslashes escaped, for passing a list as one text[] parameter
+internal char *
+pg_text_array_literal(Arena *arena, String *items, u64 count) {
+    u64 size = 3;
+    for (u64 i = 0; i < count; i++) {
+        size += items[i].size * 2 + 3;
+    }
+    char *out = push_array(arena, char, size);
+    u64   at = 0;
+    out[at++] = '{';
+    for (u64 i = 0; i < count; i++) {
+        if (i > 0) {
+            out[at++] = ',';
         }
+        out[at++] = '"';
+        for (u32 j = 0; j < items[i].size; j++) {
+            u8 ch = items[i].data[j];
+            if (ch == '"' || ch == '\\') {
+                out[at++] = '\\';
+            }
+            out[at++] = (char)ch;
+        }
+        out[at++] = '"';
+    }
+    out[at++] = '}';
+    out[at] = 0;
+    return out;
+}
 
-        char *col_name = PQgetvalue(res, r, 0);
-        char *data_type = PQgetvalue(res, r, 1);
-        char *nullable = PQgetvalue(res, r, 2);
-        char *default_val = PQgetvalue(res, r, 3);
-        char *is_fk = PQgetvalue(res, r, 4);
-        char *fk_table = PQgetvalue(res, r, 5);
-        char *fk_column = PQgetvalue(res, r, 6);
+// Primary key columns in key order
+static const char *pg_primary_key_query =
+    "SELECT a.attname "
+    "FROM pg_index i "
+    "JOIN pg_class c ON c.oid = i.indrelid "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "JOIN pg_attribute a ON a.attrelid = i.indrelid AND a.attnum = ANY (i.indkey) "
+    "WHERE i.indisprimary AND n.nspname = $1 AND c.relname = $2 "
+    "ORDER BY array_position(i.indkey::int2[], a.attnum)";
 
-        *col = (DB_Column_Info){0};
+// Fills in the key columns, none if the table has no primary key or a wider one than we page on
+internal void
+pg_resolve_page_key(Arena *arena, DB_Conn *conn, DB_Schema schema, DB_Page_Key *key) {
+    PG_Query  query = {pg_primary_key_query, {str_to_cstring(arena, schema.schema), str_to_cstring(arena, schema.name)}, 2, 0};
+    PGresult *res = pg_exec_query(conn, &query);
 
-        col->column_name = str_push_copy(arena, cstr_to_string(col_name, strlen(col_name)));
-        col->data_type = str_push_copy(arena, cstr_to_string(data_type, strlen(data_type)));
-        col->is_nullable = str_push_copy(arena, cstr_to_string(nullable, strlen(nullable)));
-        col->column_default = str_push_copy(arena, cstr_to_string(default_val, strlen(default_val)));
-        col->is_foreign_key = str_push_copy(arena, cstr_to_string(is_fk, strlen(is_fk)));
-        col->foreign_table_name = str_push_copy(arena, cstr_to_string(fk_table, strlen(fk_table)));
-        col->foreign_column_name = str_push_copy(arena, cstr_to_string(fk_column, strlen(fk_column)));
-
-        char display_buf[512];
-        snprintf(display_buf, sizeof(display_buf), "%s: %s", col_name, data_type);
-        u64 display_len = strlen(display_buf);
-        col->display_text = push_array(arena, char, display_len + 1);
-        MemoryCopy(col->display_text, display_buf, display_len + 1);
-
-        col->is_fk = (strcmp(is_fk, "YES") == 0);
-
-        if (col->is_fk) {
-            char fk_buf[256];
-            snprintf(fk_buf, sizeof(fk_buf), "  → %s", fk_table);
-            u64 fk_len = strlen(fk_buf);
-            col->fk_display = push_array(arena, char, fk_len + 1);
-            MemoryCopy(col->fk_display, fk_buf, fk_len + 1);
-        } else {
-            col->fk_display = NULL;
+    key->is_resolved = 1;
+    key->column_count = 0;
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        log_error("Failed to look up primary key: {s}", PQresultErrorMessage(res));
+    } else if (PQntuples(res) <= DB_PAGE_KEY_MAX) {
+        for (s32 r = 0; r < PQntuples(res); r++) {
+            key->columns[r] = str_push_copy(arena, cstr_to_string(PQgetvalue(res, r, 0), PQgetlength(res, r, 0)));
         }
+        key->column_count = (u32)PQntuples(res);
+    }
+    PQclear(res);
+}
+
+// Columns of a table in attnum order: name, is bytea, is json or xml, is text without a length limit
+static const char *pg_projection_query =
+    "SELECT a.attname, t.typname = 'bytea', t.typname IN ('json', 'jsonb', 'xml'), "
+    "    t.typcategory = 'S' AND a.atttypmod < 0 "
+    "FROM pg_attribute a "
+    "JOIN pg_class c ON c.oid = a.attrelid "
+    "JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "JOIN pg_type t ON t.oid = a.atttypid "
+    "WHERE n.nspname = $1 AND c.relname = $2 AND c.relkind IN ('r', 'p') "
+    "AND a.attnum > 0 AND NOT a.attisdropped "
+    "ORDER BY a.attnum";
+
+// format takes the identifier, the prefix, then the identifier again
+internal String
+pg_projection_item(Arena *arena, const char *format, const char *ident, u32 prefix) {
+    u64   size = strlen(format) + strlen(ident) * 2 + 16;
+    char *item = push_array(arena, char, size);
+    s32   len = snprintf(item, size, format, ident, prefix, ident);
+    return str((u8 *)item, (u64)Clamp(0, len, (s32)size - 1));
+}
+
+// Select list for browsing a table: text, json, xml and bytea columns are cut
+// to prefix characters (bytes for bytea), each followed at the end by its whole
+// size if it was cut, then the row's tableoid and ctid to fetch the rest by.
+// Stays * for anything but a table, a prefix of 0, or if the lookup fails.
+internal void
+pg_resolve_projection(Arena *arena, DB_Conn *conn, DB_Schema schema, u32 prefix, DB_Projection *projection) {
+    MemoryZeroStruct(projection);
+    projection->is_resolved = 1;
+    if (schema.kind != DB_SCHEMA_KIND_TABLE || prefix == 0) {
+        return;
     }
 
+    PGconn   *c = handle_to_conn(conn->handle);
+    PG_Query  query = {pg_projection_query, {str_to_cstring(arena, schema.schema), str_to_cstring(arena, schema.name)}, 2, 0};
+    PGresult *res = pg_exec_query(conn, &query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        log_error("Failed to look up columns: {s}", PQresultErrorMessage(res));
+        PQclear(res);
+        return;
+    }
+
+    String_List items = {0};
+    String_List sizes = {0};
+    b32         failed = 0;
+    for (s32 r = 0; r < PQntuples(res) && !failed; r++) {
+        char *ident = PQescapeIdentifier(c, PQgetvalue(res, r, 0), (size_t)PQgetlength(res, r, 0));
+        if (!ident) {
+            log_error("Failed to quote column name: {s}", PQerrorMessage(c));
+            failed = 1;
+            break;
+        }
+
+        const char *cut = 0;
+        const char *size = 0;
+        if (projection->wide_count == DB_PROJECTION_WIDE_MAX) {
+            // Fetched whole
+        } else if (PQgetvalue(res, r, 1)[0] == 't') {
+            cut = "substring(%s from 1 for %u) AS %s";
+            size = "CASE WHEN octet_length(%s) > %u THEN octet_length(%s) END::text";
+        } else if (PQgetvalue(res, r, 2)[0] == 't') {
+            cut = "left(%s::text, %u) AS %s";
+            size = "CASE WHEN char_length(%s::text) > %u THEN octet_length(%s::text) END::text";
+        } else if (PQgetvalue(res, r, 3)[0] == 't') {
+            cut = "left(%s, %u) AS %s";
+            size = "CASE WHEN char_length(%s) > %u THEN octet_length(%s) END::text";
+        }
+
+        if (cut) {
+            projection->wide_columns[projection->wide_count++] = (u32)r;
+            string_list_push(arena, &items, pg_projection_item(arena, cut, ident, prefix));
+            string_list_push(arena, &sizes, pg_projection_item(arena, size, ident, prefix));
+        } else {
+            string_list_push(arena, &items, str_push_copy(arena, cstr_to_string(ident, strlen(ident))));
+        }
+        PQfreemem(ident);
+    }
+    u32 column_count = (u32)PQntuples(res);
     PQclear(res);
-    Prof_End();
+
+    if (failed || projection->wide_count == 0) {
+        // Nothing to cut, plain * keeps the query the same as without a projection
+        MemoryZeroStruct(projection);
+        projection->is_resolved = 1;
+        return;
+    }
+
+    for (String_Node *node = sizes.first; node; node = node->next) {
+        string_list_push(arena, &items, node->string);
+    }
+    string_list_push(arena, &items, str_lit("tableoid::text || ' ' || ctid::text"));
+    String_Join join = {.sep = str_lit(", ")};
+    projection->select_list = str_list_join(arena, &items, &join);
+    projection->column_count = column_count;
+}
+
+// Call after pg_table_columns_from_result: hides the size and locator fields
+// and marks the cut columns, before any rows are appended
+internal void
+pg_table_apply_projection(DB_Table *table, DB_Projection *projection) {
+    table->projection = *projection;
+    table->projection.select_list = str_push_copy(table->arena, projection->select_list);
+    if (projection->wide_count == 0) {
+        return;
+    }
+    table->column_count = projection->column_count;
+    for (u32 w = 0; w < projection->wide_count; w++) {
+        DB_Column_Info *col = dyn_array_get(&table->columns, DB_Column_Info, projection->wide_columns[w]);
+        if (col) {
+            col->is_truncated = 1;
+        }
+    }
+}
+
+// Table for the result of a DB_REQUEST_TABLE_PAGE, whose key and projection
+// were resolved before it was sent. Takes res: zero copy tables keep it.
+internal DB_Table *
+pg_table_page_from_result(Arena *arena, DB_Request *request, PGresult *res) {
+    DB_Page_Key key = request->after;
+    DB_Table   *table = pg_table_alloc(request->schema);
+    table->zero_copy = request->zero_copy;
+    pg_table_columns_from_result(table, res);
+    // The trailing key columns are only read for next_page, the projection's
+    // sizes and locators before them by pg_table_append_rows
+    s32 key_field = PQnfields(res) - (s32)key.column_count;
+    table->column_count = (u64)key_field;
+    pg_table_apply_projection(table, &request->projection);
+    s32 n_rows = PQntuples(res);
+    db_table_publish_rows(table, pg_table_append_rows(arena, table, res, 0));
+
+    DB_Page_Key *next = &table->next_page;
+    next->is_resolved = 1;
+    next->column_count = key.column_count;
+    next->has_values = key.has_values || (key.column_count > 0 && n_rows > 0);
+    next->offset = key.offset + (u64)n_rows;
+    for (u32 k = 0; k < key.column_count; k++) {
+        next->columns[k] = str_push_copy(table->arena, key.columns[k]);
+        if (n_rows > 0) {
+            String value = str((u8 *)PQgetvalue(res, n_rows - 1, key_field + (s32)k), PQgetlength(res, n_rows - 1, key_field + (s32)k));
+            next->values[k] = str_push_copy(table->arena, value);
+        } else {
+            next->values[k] = str_push_copy(table->arena, key.values[k]);
+        }
+    }
+    table->is_last_page = (u32)n_rows < request->limit;
+
+    if (table->zero_copy) {
+        db_table_retain(table, DB_KIND_POSTGRES, (DB_Handle){.ptr = res});
+    } else {
+        PQclear(res);
+    }
     return table;
 }
 
-internal DB_Table *pg_get_data_from_schema(DB_Conn *conn, DB_Schema schema, u32 limit) {
+// Column info for just the given tables. Dropped tables stay null, tables
+// without columns get an empty table.
+internal b32
+pg_get_schema_info_batch(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables) {
     PROF_FUNCTION;
-    PGconn *c = handle_to_conn(conn->handle);
+    PGconn  *c = handle_to_conn(conn->handle);
+    Scratch  scratch = scratch_begin(conn->arena);
+    String  *schema_names = push_array(scratch.arena, String, Max(count, 1));
+    String  *table_names = push_array(scratch.arena, String, Max(count, 1));
+    for (u64 i = 0; i < count; i++) {
+        schema_names[i] = schemas[i].schema;
+        table_names[i] = schemas[i].name;
+    }
+    PG_Query query = {pg_some_schema_info_query,
+                      {pg_text_array_literal(scratch.arena, schema_names, count),
+                       pg_text_array_literal(scratch.arena, table_names, count)},
+                      2,
+                      0};
+    PGresult *res = pg_exec_query(conn, &query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        const char *error_msg = PQerrorMessage(c);
+        log_error("Failed to get schema info: {s}", error_msg);
+        PQclear(res);
+        scratch_end(&scratch);
+        Prof_End();
+        return 0;
+    }
+    pg_tables_from_all_schema_info(scratch.arena, res, schemas, count, tables);
+    PQclear(res);
+
+    // A table without columns has no rows above, only this tells it from a dropped one
+    query.text = pg_some_tables_query;
+    res = pg_exec_query(conn, &query);
+    b32 ok = PQresultStatus(res) == PGRES_TUPLES_OK;
+    if (ok) {
+        Hash_Table *index_by_name = hash_table_create(scratch.arena, count * 2 + 1);
+        for (u64 i = 0; i < count; i++) {
+            String key = db_schema_key(scratch.arena, schemas[i].schema, schemas[i].name);
+            hash_table_push_string_u64(scratch.arena, index_by_name, key, i);
+        }
+        for (s32 r = 0; r < PQntuples(res); r++) {
+            char           *schema_name = PQgetvalue(res, r, 0);
+            char           *table_name = PQgetvalue(res, r, 1);
+            String          key = db_schema_key(scratch.arena, cstr_to_string(schema_name, strlen(schema_name)),
+                                                cstr_to_string(table_name, strlen(table_name)));
+            Key_Value_Pair *kv = hash_table_search_string(index_by_name, key);
+            if (kv && !tables[kv->value_u64]) {
+                tables[kv->value_u64] = pg_table_alloc(schemas[kv->value_u64]);
+            }
+        }
+    } else {
+        // Without it every table would look dropped
+        log_error("Failed to get schema info: {s}", PQerrorMessage(c));
+        for (u64 i = 0; i < count; i++) {
+            db_free_schema_info(tables[i]);
+            tables[i] = 0;
+        }
+    }
+    PQclear(res);
+    scratch_end(&scratch);
+    Prof_End();
+    return ok;
+}
+
+#define PG_DDL_CHANNEL "dbui_ddl"
 
-    Arena    *arena = arena_alloc();
-    DB_Table *table = push_struct_zero(arena, DB_Table);
-    table->arena = arena;
-    table->schema = schema;
+// Event triggers that NOTIFY PG_DDL_CHANNEL with quote_ident(schema) || '.' ||
+// quote_ident(table) for each table a DDL command created, altered or dropped.
+// Quoting keeps the two names apart when either has a dot in it. Constraints and defaults
+// resolve to their table, so FK changes reach the referencing side.
+static const char *pg_ddl_trigger_install_query =
+    "CREATE OR REPLACE FUNCTION dbui_notify_ddl() RETURNS event_trigger LANGUAGE plpgsql AS $fn$ "
+    "DECLARE r record; "
+    "BEGIN "
+    "    IF tg_event = 'sql_drop' THEN "
+    "        FOR r IN SELECT DISTINCT address_names[1] AS nspname, address_names[2] AS relname "
+    "                 FROM pg_event_trigger_dropped_objects() "
+    "                 WHERE object_type IN ('table', 'table column', 'table constraint') AND NOT is_temporary LOOP "
+    "            PERFORM pg_notify('" PG_DDL_CHANNEL "', quote_ident(r.nspname) || '.' || quote_ident(r.relname)); "
+    "        END LOOP; "
+    "    ELSE "
+    "        FOR r IN SELECT DISTINCT n.nspname, c.relname "
+    "                 FROM pg_event_trigger_ddl_commands() d "
+    "                 LEFT JOIN pg_constraint k ON d.classid = 'pg_constraint'::regclass AND k.oid = d.objid "
+    "                 LEFT JOIN pg_attrdef a ON d.classid = 'pg_attrdef'::regclass AND a.oid = d.objid "
+    "                 JOIN pg_class c ON c.oid = COALESCE(k.conrelid, a.adrelid, "
+    "                     CASE WHEN d.classid = 'pg_class'::regclass THEN d.objid END) "
+    "                 JOIN pg_namespace n ON n.oid = c.relnamespace "
+    "                 WHERE c.relkind IN ('r', 'p') AND NOT d.in_extension LOOP "
+    "            PERFORM pg_notify('" PG_DDL_CHANNEL "', quote_ident(r.nspname) || '.' || quote_ident(r.relname)); "
+    "        END LOOP; "
+    "    END IF; "
+    "END $fn$; "
+    "DROP EVENT TRIGGER IF EXISTS dbui_ddl_end; "
+    "CREATE EVENT TRIGGER dbui_ddl_end ON ddl_command_end EXECUTE FUNCTION dbui_notify_ddl(); "
+    "DROP EVENT TRIGGER IF EXISTS dbui_sql_drop; "
+    "CREATE EVENT TRIGGER dbui_sql_drop ON sql_drop EXECUTE FUNCTION dbui_notify_ddl();";
 
-    table->columns = (Dyn_Array){0};
-    table->rows = (Dyn_Array){0};
+// LISTEN for DDL notifications, installing the event triggers first if asked.
+// Installing needs superuser, without the triggers nothing is ever sent.
+internal b32
+pg_watch_ddl(DB_Conn *conn, b32 install_trigger) {
+    PGconn *c = handle_to_conn(conn->handle);
+    if (install_trigger) {
+        PGresult *res = PQexec(c, pg_ddl_trigger_install_query);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            log_error("Failed to install the DDL event trigger: {s}", PQerrorMessage(c));
+        }
+        PQclear(res);
+    }
 
-    char        table_name[512];
-    const char *schema_cstr = str_to_cstring(arena, schema.schema);
-    const char *name_cstr = str_to_cstring(arena, schema.name);
+    PGresult *res = PQexec(c, "LISTEN " PG_DDL_CHANNEL);
+    b32       ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        log_error("Failed to listen for DDL: {s}", PQerrorMessage(c));
+    }
+    PQclear(res);
+    return ok;
+}
 
-    if (schema.schema.size > 0 && !str_match(schema.schema, str_lit("public"))) {
-        snprintf(table_name, sizeof(table_name), "%s.%s", schema_cstr, name_cstr);
+// One name of a DDL payload, as quote_ident wrote it: in double quotes with
+// inner quotes doubled, or bare up to the next dot. Advances rest past it.
+internal String
+pg_ddl_payload_ident(Arena *arena, String *rest) {
+    String in = *rest;
+    u8    *out = push_array(arena, u8, Max(in.size, 1));
+    u64    size = 0;
+    u64    at = 0;
+    if (in.size && in.data[0] == '"') {
+        for (at = 1; at < in.size; at++) {
+            if (in.data[at] == '"') {
+                if (at + 1 < in.size && in.data[at + 1] == '"') {
+                    out[size++] = '"';
+                    at++;
+                    continue;
+                }
+                at++;
+                break;
+            }
+            out[size++] = in.data[at];
+        }
     } else {
-        snprintf(table_name, sizeof(table_name), "%s", name_cstr);
+        for (; at < in.size && in.data[at] != '.'; at++) {
+            out[size++] = in.data[at];
+        }
+    }
+    *rest = str(in.data + at, in.size - at);
+    return str(out, size);
+}
+
+// Waits up to timeout_ms for notifications and appends the tables they name
+// to tables. Returns 0 once the connection is broken.
+internal b32
+pg_wait_ddl(DB_Conn *conn, Arena *arena, s32 timeout_ms, DB_Schema_List *tables) {
+    PGconn *c = handle_to_conn(conn->handle);
+    if (!pg_wait_readable(c, timeout_ms) || !PQconsumeInput(c)) {
+        return 0;
+    }
+    for (PGnotify *notify = PQnotifies(c); notify; notify = PQnotifies(c)) {
+        String    rest = cstr_to_string(notify->extra, strlen(notify->extra));
+        DB_Schema schema = {0};
+        schema.kind = DB_SCHEMA_KIND_TABLE;
+        schema.schema = pg_ddl_payload_ident(arena, &rest);
+        if (rest.size && rest.data[0] == '.') {
+            rest = str(rest.data + 1, rest.size - 1);
+            // Triggers from before the names were quoted send a bare rest, dots and all
+            schema.name = rest.size && rest.data[0] == '"' ? pg_ddl_payload_ident(arena, &rest) : str_push_copy(arena, rest);
+            DB_Schema_Node *node = push_struct_zero(arena, DB_Schema_Node);
+            node->v = schema;
+            DLLPushBack_NPZ(0, tables->first, tables->last, node, next, prev);
+            tables->count++;
+        }
+        PQfreemem(notify);
     }
+    return PQstatus(c) == CONNECTION_OK;
+}
 
-    char query_buffer[1024];
-    snprintf(query_buffer, sizeof(query_buffer), "SELECT * FROM %s LIMIT %u", table_name, limit);
+internal DB_Table *pg_get_data_from_schema(DB_Conn *conn, DB_Schema schema, u32 limit) {
+    PROF_FUNCTION;
+    PGconn *c = handle_to_conn(conn->handle);
 
-    PGresult *res = PQexec(c, query_buffer);
+    Scratch scratch = scratch_begin(conn->arena);
+    char    limit_param[16];
+    snprintf(limit_param, sizeof(limit_param), "%u", limit);
+    PG_Query  query = {pg_data_query(scratch.arena, c, schema, "*", DB_SAMPLE_NONE), {limit_param}, 1, 0};
+    PGresult *res = query.text ? pg_exec_query(conn, &query) : 0;
+    scratch_end(&scratch);
 
     if (!res) {
         const char *error_msg = PQerrorMessage(c);
         if (error_msg) {
             log_error("PostgreSQL error: {S}", cstr_to_string(error_msg, strlen(error_msg)));
         }
-        arena_release(arena);
+        Prof_End();
         return 0;
     }
 
@@ -276,38 +1441,540 @@ internal DB_Table *pg_get_data_from_schema(DB_Conn *conn, DB_Schema schema, u32
             log_error("Query error: {S}", cstr_to_string(error_msg, strlen(error_msg)));
         }
         PQclear(res);
-        arena_release(arena);
         Prof_End();
         return 0;
     }
 
-    table->row_count = PQntuples(res);
-    table->column_count = PQnfields(res);
+    // One result holds every row, referencing it saves a copy and arena space per cell
+    DB_Table *table = pg_table_from_data(conn->arena, res, schema, 1);
+    Prof_End();
+    return table;
+}
 
-    for (u64 c = 0; c < table->column_count; c++) {
-        DB_Column_Info *col = dyn_array_push(arena, &table->columns, DB_Column_Info);
-        const char     *col_name = PQfname(res, (int)c);
-        col->column_name = str_push_copy(arena, cstr_to_string(col_name, strlen(col_name)));
+////////////////////////////////
+// Async execution, used by the DB worker thread
 
-        // For data display, we don't have type info, but we can still cache the name
-        col->display_text = push_array(arena, char, strlen(col_name) + 1);
-        MemoryCopy(col->display_text, col_name, strlen(col_name) + 1);
-        col->is_fk = false;
-        col->fk_display = NULL;
+internal b32
+pg_send_request(DB_Conn *conn, DB_Request *request) {
+    PGconn *c = handle_to_conn(conn->handle);
+    b32     sent = 0;
+
+    Scratch  scratch = scratch_begin(conn->arena);
+    PG_Query query = pg_request_query(scratch.arena, c, request);
+    if (query.text) {
+        sent = pg_send_query(conn, &query);
     }
+    scratch_end(&scratch);
 
-    for (u64 r = 0; r < table->row_count; r++) {
-        DB_Row *row = dyn_array_push(arena, &table->rows, DB_Row);
+    if (!sent) {
+        const char *error_msg = PQerrorMessage(c);
+        log_error("Failed to send query: {s}", error_msg);
+    }
+    return sent;
+}
 
-        for (u64 c = 0; c < table->column_count; c++) {
-            char   *value_str = PQgetvalue(res, (int)r, (int)c);
-            String  value = cstr_to_string(value_str, strlen(value_str));
-            String *stored_value = dyn_array_push(arena, &row->values, String);
-            *stored_value = str_push_copy(arena, value);
+// Next result of the query in flight, without ever blocking in libpq: the
+// socket is polled with a short timeout so shutdown and cancellation are
+// noticed while the server is still working. Null when the query is done.
+internal PGresult *
+pg_next_result(PGconn *c, b32 *is_live, b32 *cancel_requested, b32 *cancel_sent) {
+    for (;;) {
+        if (!PQconsumeInput(c)) {
+            const char *error_msg = PQerrorMessage(c);
+            log_error("Connection error: {s}", error_msg);
+            break;
+        }
+        if (!PQisBusy(c)) {
+            break;
         }
+        b32 wants_cancel = !ins_atomic_u32_eval(is_live) ||
+                           (cancel_requested && ins_atomic_u32_eval(cancel_requested));
+        if (wants_cancel && !*cancel_sent) {
+            // Ask the server to stop, the remaining results still have to be drained
+            PGcancel *cancel = PQgetCancel(c);
+            if (cancel) {
+                char err[256];
+                PQcancel(cancel, err, sizeof(err));
+                PQfreeCancel(cancel);
+            }
+            *cancel_sent = 1;
+        }
+        pg_wait_readable(c, 50);
     }
+    return PQgetResult(c);
+}
 
-    PQclear(res);
+// Rows arrive one (or one chunk) at a time and are appended straight into the
+// table's pages, so libpq never holds more than a chunk. The table is handed to
+// the UI as soon as the first batch is in, then keeps growing.
+internal DB_Table *
+pg_stream_table_data(DB_Conn *conn, DB_Request *request, b32 *is_live) {
+    PGconn   *c = handle_to_conn(conn->handle);
+    DB_Table *table = pg_table_alloc(request->schema);
+    u64       row_count = 0;
+    b32       cancel_sent = 0;
+    b32       posted = 0;
+    b32       failed = 0;
+    f64       last_publish = os_get_time();
+
+    table->is_streaming = 1;
+
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    // Retaining a result per single row would cost more than the copies it saves
+    table->zero_copy = request->zero_copy;
+    PQsetChunkedRowsMode(c, 256);
+#else
+    PQsetSingleRowMode(c);
+#endif
+
+    for (PGresult *res; (res = pg_next_result(c, is_live, &table->cancel_requested, &cancel_sent));) {
+        ExecStatusType status = PQresultStatus(res);
+        b32            has_rows = status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK;
+#ifdef LIBPQ_HAS_CHUNK_MODE
+        has_rows = has_rows || status == PGRES_TUPLES_CHUNK;
+#endif
+        if (has_rows) {
+            if (table->column_count == 0) {
+                pg_table_columns_from_result(table, res);
+                pg_table_apply_projection(table, &request->projection);
+            }
+            if (!cancel_sent && PQntuples(res) > 0) {
+                row_count = pg_table_append_rows(conn->arena, table, res, row_count);
+                if (table->zero_copy) {
+                    db_table_retain(table, DB_KIND_POSTGRES, (DB_Handle){.ptr = res});
+                    res = 0;
+                }
+            }
+
+            // Publishing per row would be fine for the reader, batching keeps the queue quiet
+            f64 now = os_get_time();
+            if (!posted || status == PGRES_TUPLES_OK || now - last_publish > 0.016 || row_count % DB_ROW_PAGE_CAP == 0) {
+                db_table_publish_rows(table, row_count);
+                last_publish = now;
+                if (!posted && request->async) {
+                    db_async_post_partial(request->async, request, table);
+                    posted = 1;
+                }
+            }
+        } else if (status != PGRES_COMMAND_OK) {
+            const char *error_msg = PQresultErrorMessage(res);
+            if (!cancel_sent) {
+                log_error("Query error: {s}", error_msg);
+            }
+            failed = 1;
+        }
+        if (res) {
+            PQclear(res);
+        }
+    }
+
+    db_table_publish_rows(table, row_count);
+    if (failed) {
+        ins_atomic_u32_eval_assign(&table->stream_failed, 1);
+    }
+
+    // Nobody saw the table yet and there is nothing in it, report a plain failure
+    if (failed && !posted && row_count == 0) {
+        db_free_schema_info(table);
+        return 0;
+    }
+    return table;
+}
+
+// Reads the results of a request that was already sent
+internal DB_Table *
+pg_receive_request(DB_Conn *conn, DB_Request *request, b32 *is_live) {
+    PGconn   *c = handle_to_conn(conn->handle);
+    DB_Table *table = 0;
+
+    if (request->kind == DB_REQUEST_TABLE_DATA || request->kind == DB_REQUEST_ROW_ESTIMATES ||
+        request->kind == DB_REQUEST_CELL_VALUE) {
+        return pg_stream_table_data(conn, request, is_live);
+    }
+
+    b32 cancel_sent = 0;
+    for (PGresult *res; (res = pg_next_result(c, is_live, 0, &cancel_sent));) {
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_TUPLES_OK && !table && request->kind == DB_REQUEST_TABLE_PAGE) {
+            table = pg_table_page_from_result(conn->arena, request, res);
+            continue;
+        } else if (status == PGRES_TUPLES_OK && !table) {
+            table = pg_table_from_schema_info(res, request->schema);
+        } else if (status != PGRES_TUPLES_OK && status != PGRES_COMMAND_OK) {
+            const char *error_msg = PQresultErrorMessage(res);
+            log_error("Query error: {s}", error_msg);
+        }
+        PQclear(res);
+    }
+    return table;
+}
+
+internal DB_Table *
+pg_run_request(DB_Conn *conn, DB_Request *request, b32 *is_live) {
+    PROF_FUNCTION;
+    DB_Table *table = 0;
+    if (pg_send_request(conn, request)) {
+        table = pg_receive_request(conn, request, is_live);
+    }
     Prof_End();
     return table;
 }
+
+// Runs a list of requests, posting each one's final result through
+// db_async_post_result as soon as its rows are in. With libpq pipelining every
+// query is sent before the first result is read, so the batch costs about one
+// round trip instead of one per request.
+internal void
+pg_run_requests(DB_Conn *conn, DB_Request *first, b32 *is_live) {
+    PROF_FUNCTION;
+    PGconn *c = handle_to_conn(conn->handle);
+    b32     pipelined = 0;
+
+    // Data requests look up what to cut first, and the first page its primary
+    // key, blocking, before any pipeline is open
+    Scratch resolved = scratch_begin(conn->arena);
+    for (DB_Request *request = first; request; request = request->next) {
+        b32 is_data = request->kind == DB_REQUEST_TABLE_DATA || request->kind == DB_REQUEST_TABLE_PAGE;
+        if (is_data && !request->projection.is_resolved) {
+            pg_resolve_projection(resolved.arena, conn, request->schema, request->cell_prefix, &request->projection);
+        }
+        if (request->kind == DB_REQUEST_TABLE_PAGE && !request->after.is_resolved) {
+            pg_resolve_page_key(resolved.arena, conn, request->schema, &request->after);
+        }
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    if (first && first->next) {
+        // Statements can't be prepared once the pipeline is open, do it up front
+        Scratch scratch = scratch_begin(conn->arena);
+        for (DB_Request *request = first; request; request = request->next) {
+            PG_Query query = pg_request_query(scratch.arena, c, request);
+            if (query.text) {
+                pg_statement_name(scratch.arena, conn, query.text, query.param_count);
+            }
+        }
+        scratch_end(&scratch);
+        pipelined = PQenterPipelineMode(c);
+    }
+#endif
+
+    if (!pipelined) {
+        for (DB_Request *request = first, *next = 0; request; request = next) {
+            next = request->next;
+            db_async_post_result(request->async, request, pg_run_request(conn, request, is_live));
+        }
+        scratch_end(&resolved);
+        Prof_End();
+        return;
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    Scratch scratch = scratch_begin(conn->arena);
+    u64     count = 0;
+    for (DB_Request *request = first; request; request = request->next) {
+        count++;
+    }
+
+    b32 *sent = push_array_zero(scratch.arena, b32, count);
+    u64  i = 0;
+    for (DB_Request *request = first; request; request = request->next, i++) {
+        sent[i] = pg_send_request(conn, request);
+    }
+    if (!PQpipelineSync(c)) {
+        log_error("Failed to sync pipeline: {s}", PQerrorMessage(c));
+    }
+
+    // Results come back in send order, one null terminated run per query.
+    // After a failed query the rest up to the sync come back as aborted.
+    i = 0;
+    for (DB_Request *request = first, *next = 0; request; request = next, i++) {
+        next = request->next;
+        DB_Table *table = sent[i] ? pg_receive_request(conn, request, is_live) : 0;
+        db_async_post_result(request->async, request, table);
+    }
+    scratch_end(&scratch);
+
+    // Drain up to the sync point, a dead connection only ever returns null
+    b32 cancel_sent = 0;
+    for (u32 null_count = 0; null_count < 2;) {
+        PGresult *res = pg_next_result(c, is_live, 0, &cancel_sent);
+        if (!res) {
+            null_count++;
+            continue;
+        }
+        null_count = 0;
+        ExecStatusType status = PQresultStatus(res);
+        PQclear(res);
+        if (status == PGRES_PIPELINE_SYNC) {
+            break;
+        }
+    }
+    if (!PQexitPipelineMode(c)) {
+        log_error("Failed to leave pipeline mode: {s}", PQerrorMessage(c));
+    }
+#endif
+    scratch_end(&resolved);
+    Prof_End();
+}
+
+#define PG_EXPORT_BUFFER_SIZE       MB(8)
+#define PG_EXPORT_PROGRESS_INTERVAL 0.25
+
+internal char *
+pg_export_query(Arena *arena, PGconn *c, DB_Request *request) {
+    const char *options = "FORMAT csv, HEADER true";
+    if (request->export_format == DB_EXPORT_FORMAT_TEXT) {
+        options = "FORMAT text";
+    } else if (request->export_format == DB_EXPORT_FORMAT_BINARY) {
+        options = "FORMAT binary";
+    }
+
+    if (request->export_query.size) {
+        // COPY (...) doesn't take a trailing semicolon
+        String query = request->export_query;
+        while (query.size) {
+            u8 last = query.data[query.size - 1];
+            if (last != ';' && last != ' ' && last != '\t' && last != '\r' && last != '\n')
+                break;
+            query.size--;
+        }
+        u64   size = query.size + strlen(options) + 48;
+        char *copy = push_array(arena, char, size);
+        snprintf(copy, size, "COPY (%.*s) TO STDOUT WITH (%s)", (int)query.size, (char *)query.data, options);
+        return copy;
+    }
+
+    char *table = pg_quote_table(arena, c, request->schema);
+    if (!table)
+        return 0;
+    u64   size = strlen(table) + strlen(options) + 64;
+    char *copy = push_array(arena, char, size);
+    if (request->schema.kind == DB_SCHEMA_KIND_TABLE) {
+        snprintf(copy, size, "COPY %s TO STDOUT WITH (%s)", table, options);
+    } else {
+        // Only plain tables can be copied directly
+        snprintf(copy, size, "COPY (SELECT * FROM %s) TO STDOUT WITH (%s)", table, options);
+    }
+    return copy;
+}
+
+internal b32
+pg_export_write(OS_Handle file, u64 *offset, u8 *data, u64 size) {
+    while (size > 0) {
+        u64 written = os_file_write(file, (Rng1_u64){{{*offset, *offset + size}}}, data);
+        if (written == 0) {
+            return 0;
+        }
+        *offset += written;
+        data += written;
+        size -= written;
+    }
+    return 1;
+}
+
+// COPY ... TO STDOUT into a local file. Rows come off the socket as the server
+// sends them and are gathered into one large buffer per write, so memory stays
+// flat and the export runs as fast as the network. Progress is posted while it
+// runs if the request came through DB_Async.
+internal b32
+pg_export(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows) {
+    PROF_FUNCTION;
+    PGconn *c = handle_to_conn(conn->handle);
+    Scratch scratch = scratch_begin(conn->arena);
+    char   *query = pg_export_query(scratch.arena, c, request);
+    *out_bytes = 0;
+    *out_rows = 0;
+
+    OS_Handle file = query ? os_open_file(request->export_path, OS_Access_Flag_Write) : os_handle_zero();
+    if (os_handle_is_zero(file)) {
+        if (query) {
+            log_error("Failed to open export file: {s}", str_to_cstring(scratch.arena, request->export_path));
+        }
+        scratch_end(&scratch);
+        Prof_End();
+        return 0;
+    }
+
+    b32 ok = PQsendQuery(c, query);
+    b32 cancel_sent = 0;
+    if (!ok) {
+        log_error("Failed to start export: {s}", PQerrorMessage(c));
+    } else {
+        PGresult *res = pg_next_result(c, is_live, 0, &cancel_sent);
+        ok = res && PQresultStatus(res) == PGRES_COPY_OUT;
+        if (res && !ok) {
+            log_error("Export failed: {s}", PQresultErrorMessage(res));
+        }
+        PQclear(res);
+    }
+
+    u8 *buffer = push_array_no_zero(scratch.arena, u8, PG_EXPORT_BUFFER_SIZE);
+    u64 used = 0;
+    u64 offset = 0;
+    f64 last_progress = os_get_time();
+    while (ok || cancel_sent) {
+        char *row = 0;
+        s32   size = PQgetCopyData(c, &row, 1);
+        if (size > 0) {
+            if (ok && used + (u64)size > PG_EXPORT_BUFFER_SIZE) {
+                ok = pg_export_write(file, &offset, buffer, used);
+                used = 0;
+            }
+            if (ok && (u64)size > PG_EXPORT_BUFFER_SIZE) {
+                ok = pg_export_write(file, &offset, (u8 *)row, (u64)size);
+            } else if (ok) {
+                MemoryCopy(buffer + used, row, size);
+                used += size;
+            }
+            PQfreemem(row);
+        } else if (size == 0) {
+            pg_wait_readable(c, 50);
+            if (!PQconsumeInput(c)) {
+                break;
+            }
+        } else {
+            // -1 is the end of the data, -2 an error the final result reports
+            break;
+        }
+
+        if ((!ok || !ins_atomic_u32_eval(is_live)) && !cancel_sent) {
+            // The rest of the data still has to be drained before the connection is usable
+            PGcancel *cancel = PQgetCancel(c);
+            if (cancel) {
+                char err[256];
+                PQcancel(cancel, err, sizeof(err));
+                PQfreeCancel(cancel);
+            }
+            cancel_sent = 1;
+            ok = 0;
+        }
+
+        f64 now = os_get_time();
+        if (request->async && ok && now - last_progress > PG_EXPORT_PROGRESS_INTERVAL) {
+            db_async_post_copy_progress(request->async, request, offset + used);
+            last_progress = now;
+        }
+    }
+    if (ok && used) {
+        ok = pg_export_write(file, &offset, buffer, used);
+    }
+
+    for (PGresult *res; (res = pg_next_result(c, is_live, 0, &cancel_sent));) {
+        if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+            *out_rows = strtoull(PQcmdTuples(res), 0, 10);
+        } else {
+            if (!cancel_sent) {
+                log_error("Export failed: {s}", PQresultErrorMessage(res));
+            }
+            ok = 0;
+        }
+        PQclear(res);
+    }
+    os_file_close(file);
+
+    *out_bytes = offset;
+    scratch_end(&scratch);
+    Prof_End();
+    return ok;
+}
+
+#define PG_IMPORT_PIECE_SIZE MB(1)
+
+// COPY ... FROM STDIN for one slice of a CSV file. The slice is sent straight
+// from the caller's memory in large pieces, libpq only buffers one at a time.
+// Each request commits on its own, a failed slice doesn't undo the others.
+internal b32
+pg_import(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows) {
+    PROF_FUNCTION;
+    PGconn *c = handle_to_conn(conn->handle);
+    Scratch scratch = scratch_begin(conn->arena);
+    *out_bytes = 0;
+    *out_rows = 0;
+
+    char *table = pg_quote_table(scratch.arena, c, request->schema);
+    u64   size = (table ? strlen(table) : 0) + 64;
+    for (u64 i = 0; i < request->import_column_count; i++) {
+        size += request->import_columns[i].size * 2 + 4;
+    }
+    char *query = push_array(scratch.arena, char, size);
+    u64   at = snprintf(query, size, "COPY %s (", table ? table : "");
+    for (u64 i = 0; i < request->import_column_count && table; i++) {
+        String column = request->import_columns[i];
+        char  *ident = PQescapeIdentifier(c, (char *)column.data, column.size);
+        if (!ident) {
+            log_error("Failed to quote import column: {s}", PQerrorMessage(c));
+            table = 0;
+            break;
+        }
+        at += snprintf(query + at, size - at, "%s%s", i ? ", " : "", ident);
+        PQfreemem(ident);
+    }
+    snprintf(query + at, size - at, ") FROM STDIN WITH (FORMAT csv)");
+
+    b32 ok = table && PQsendQuery(c, query);
+    b32 cancel_sent = 0;
+    if (table && !ok) {
+        log_error("Failed to start import: {s}", PQerrorMessage(c));
+    } else if (ok) {
+        PGresult *res = pg_next_result(c, is_live, 0, &cancel_sent);
+        ok = res && PQresultStatus(res) == PGRES_COPY_IN;
+        if (res && !ok) {
+            log_error("Import failed: {s}", PQresultErrorMessage(res));
+        }
+        PQclear(res);
+    }
+    if (!ok) {
+        // Nothing to end if COPY never started, just collect what the server said
+        for (PGresult *res; (res = pg_next_result(c, is_live, 0, &cancel_sent));) {
+            PQclear(res);
+        }
+        scratch_end(&scratch);
+        Prof_End();
+        return 0;
+    }
+
+    String data = request->import_data;
+    u64    sent = 0;
+    f64    last_progress = os_get_time();
+    while (ok && sent < data.size) {
+        if (!ins_atomic_u32_eval(is_live)) {
+            break;
+        }
+        u64 piece = Min(data.size - sent, PG_IMPORT_PIECE_SIZE);
+        if (PQputCopyData(c, (char *)data.data + sent, (s32)piece) != 1) {
+            log_error("Import failed: {s}", PQerrorMessage(c));
+            ok = 0;
+            break;
+        }
+        sent += piece;
+
+        f64 now = os_get_time();
+        if (request->async && now - last_progress > PG_EXPORT_PROGRESS_INTERVAL) {
+            db_async_post_copy_progress(request->async, request, sent);
+            last_progress = now;
+        }
+    }
+
+    // An error message makes the server roll the COPY back
+    b32 is_complete = ok && sent == data.size;
+    if (PQputCopyEnd(c, is_complete ? 0 : "import cancelled") != 1) {
+        log_error("Failed to end import: {s}", PQerrorMessage(c));
+    }
+    ok = is_complete;
+    for (PGresult *res; (res = pg_next_result(c, is_live, 0, &cancel_sent));) {
+        if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+            *out_rows = strtoull(PQcmdTuples(res), 0, 10);
+        } else {
+            if (is_complete) {
+                log_error("Import failed: {s}", PQresultErrorMessage(res));
+            }
+            ok = 0;
+        }
+        PQclear(res);
+    }
+
+    *out_bytes = sent;
+    scratch_end(&scratch);
+    Prof_End();
+    return ok;
+}
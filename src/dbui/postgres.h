@@ -4,6 +4,17 @@
 #include "dbui.h"
 
 internal DB_Conn       *pg_connect(DB_Config config);
+internal b32            pg_check_connection(DB_Conn *conn);
 internal DB_Schema_List pg_get_all_schemas(DB_Conn *conn);
 internal DB_Table      *pg_get_schema_info(DB_Conn *conn, DB_Schema schema);
+internal u64            pg_get_catalog_fingerprint(DB_Conn *conn);
+internal b32            pg_get_all_schema_info(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables);
+internal b32            pg_get_schema_info_batch(DB_Conn *conn, DB_Schema *schemas, u64 count, DB_Table **tables);
+internal b32            pg_watch_ddl(DB_Conn *conn, b32 install_trigger);
+internal b32            pg_wait_ddl(DB_Conn *conn, Arena *arena, s32 timeout_ms, DB_Schema_List *tables);
 internal DB_Table      *pg_get_data_from_schema(DB_Conn *conn, DB_Schema schema, u32 limit);
+internal b32            pg_export(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows);
+internal b32            pg_import(DB_Conn *conn, DB_Request *request, b32 *is_live, u64 *out_bytes, u64 *out_rows);
+internal DB_Table      *pg_run_request(DB_Conn *conn, DB_Request *request, b32 *is_live);
+internal void           pg_run_requests(DB_Conn *conn, DB_Request *first, b32 *is_live);
+internal void           pg_result_release(DB_Handle handle);
@@ -0,0 +1,215 @@
+#include "spatial_grid.h"
+
+internal u64
+spatial_grid_cell_hash(s32 x, s32 y) {
+    u64 key = ((u64)(u32)x << 32) | (u64)(u32)y;
+    return hash_key_u64(key);
+}
+
+internal Spatial_Grid_Cell_Range
+spatial_grid_cell_range(Spatial_Grid *grid, Rng2_f32 rect) {
+    Spatial_Grid_Cell_Range result = {0};
+    result.x0 = (s32)floorf(rect.min.x / grid->cell_size);
+    result.y0 = (s32)floorf(rect.min.y / grid->cell_size);
+    result.x1 = (s32)floorf(rect.max.x / grid->cell_size);
+    result.y1 = (s32)floorf(rect.max.y / grid->cell_size);
+    return result;
+}
+
+internal Spatial_Grid_Cell *
+spatial_grid_cell_from_coord(Spatial_Grid *grid, s32 x, s32 y, b32 create) {
+    u64                slot = spatial_grid_cell_hash(x, y) % grid->slots_count;
+    Spatial_Grid_Cell *cell = grid->slots[slot];
+    for (; cell; cell = cell->hash_next) {
+        if (cell->x == x && cell->y == y) {
+            return cell;
+        }
+    }
+    if (create) {
+        cell = push_struct_zero(grid->arena, Spatial_Grid_Cell);
+        cell->x = x;
+        cell->y = y;
+        cell->hash_next = grid->slots[slot];
+        grid->slots[slot] = cell;
+    }
+    return cell;
+}
+
+internal void
+spatial_grid_link(Spatial_Grid *grid, u32 id, Spatial_Grid_Cell_Range cells) {
+    for (s32 y = cells.y0; y <= cells.y1; y++) {
+        for (s32 x = cells.x0; x <= cells.x1; x++) {
+            Spatial_Grid_Cell  *cell = spatial_grid_cell_from_coord(grid, x, y, 1);
+            Spatial_Grid_Entry *entry = grid->free_entries;
+            if (entry) {
+                SLLStackPop_N(grid->free_entries, next);
+            } else {
+                entry = push_struct(grid->arena, Spatial_Grid_Entry);
+            }
+            entry->id = id;
+            if (!cell->first) {
+                DLLPushBack_NPZ(0, grid->first_occupied, grid->last_occupied, cell, occupied_next, occupied_prev);
+                grid->occupied_count += 1;
+            }
+            SLLStackPush_N(cell->first, entry, next);
+        }
+    }
+}
+
+internal void
+spatial_grid_unlink(Spatial_Grid *grid, u32 id, Spatial_Grid_Cell_Range cells) {
+    for (s32 y = cells.y0; y <= cells.y1; y++) {
+        for (s32 x = cells.x0; x <= cells.x1; x++) {
+            Spatial_Grid_Cell *cell = spatial_grid_cell_from_coord(grid, x, y, 0);
+            if (!cell)
+                continue;
+            for (Spatial_Grid_Entry **ptr = &cell->first; *ptr; ptr = &(*ptr)->next) {
+                if ((*ptr)->id == id) {
+                    Spatial_Grid_Entry *entry = *ptr;
+                    *ptr = entry->next;
+                    SLLStackPush_N(grid->free_entries, entry, next);
+                    if (!cell->first) {
+                        DLLRemove_NPZ(0, grid->first_occupied, grid->last_occupied, cell, occupied_next, occupied_prev);
+                        grid->occupied_count -= 1;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+internal Spatial_Grid *
+spatial_grid_alloc(f32 cell_size, u32 item_cap) {
+    Arena        *arena = arena_alloc();
+    Spatial_Grid *grid = push_struct_zero(arena, Spatial_Grid);
+    grid->arena = arena;
+    grid->cell_size = cell_size;
+    grid->slots_count = Max((u64)item_cap * 2, 64);
+    grid->slots = push_array_zero(arena, Spatial_Grid_Cell *, grid->slots_count);
+    grid->item_cap = item_cap;
+    grid->items = push_array_zero(arena, Spatial_Grid_Item, Max(item_cap, 1));
+    return grid;
+}
+
+internal void
+spatial_grid_release(Spatial_Grid *grid) {
+    if (grid) {
+        arena_release(grid->arena);
+    }
+}
+
+internal void
+spatial_grid_insert(Spatial_Grid *grid, u32 id, Rng2_f32 rect) {
+    ASSERT(id < grid->item_cap, "Spatial grid id out of range");
+    Spatial_Grid_Item *item = &grid->items[id];
+    if (item->is_live) {
+        spatial_grid_update(grid, id, rect);
+        return;
+    }
+    item->rect = rect;
+    item->cells = spatial_grid_cell_range(grid, rect);
+    item->is_live = 1;
+    spatial_grid_link(grid, id, item->cells);
+}
+
+internal void
+spatial_grid_update(Spatial_Grid *grid, u32 id, Rng2_f32 rect) {
+    ASSERT(id < grid->item_cap, "Spatial grid id out of range");
+    Spatial_Grid_Item *item = &grid->items[id];
+    if (!item->is_live) {
+        spatial_grid_insert(grid, id, rect);
+        return;
+    }
+
+    // Small drags mostly stay inside the same cells, only the rect changes then
+    Spatial_Grid_Cell_Range cells = spatial_grid_cell_range(grid, rect);
+    if (MemoryCompare(&cells, &item->cells, sizeof(cells)) != 0) {
+        spatial_grid_unlink(grid, id, item->cells);
+        spatial_grid_link(grid, id, cells);
+        item->cells = cells;
+    }
+    item->rect = rect;
+}
+
+internal void
+spatial_grid_remove(Spatial_Grid *grid, u32 id) {
+    if (id >= grid->item_cap || !grid->items[id].is_live)
+        return;
+    Spatial_Grid_Item *item = &grid->items[id];
+    spatial_grid_unlink(grid, id, item->cells);
+    item->is_live = 0;
+}
+
+// Returns the lowest id whose rect contains the point, or -1
+internal s64
+spatial_grid_pick(Spatial_Grid *grid, Vec2_f32 point) {
+    s64                result = -1;
+    s32                x = (s32)floorf(point.x / grid->cell_size);
+    s32                y = (s32)floorf(point.y / grid->cell_size);
+    Spatial_Grid_Cell *cell = spatial_grid_cell_from_coord(grid, x, y, 0);
+    if (cell) {
+        for (Spatial_Grid_Entry *entry = cell->first; entry; entry = entry->next) {
+            Rng2_f32 r = grid->items[entry->id].rect;
+            if (point.x >= r.min.x && point.x <= r.max.x &&
+                point.y >= r.min.y && point.y <= r.max.y &&
+                (result < 0 || entry->id < (u64)result)) {
+                result = entry->id;
+            }
+        }
+    }
+    return result;
+}
+
+// All ids whose rect overlaps the query rect, each id once, in unspecified order
+internal void
+spatial_grid_query_cell(Spatial_Grid *grid, Spatial_Grid_Cell *cell, Rng2_f32 rect, Spatial_Grid_Result *result) {
+    for (Spatial_Grid_Entry *entry = cell->first; entry; entry = entry->next) {
+        Spatial_Grid_Item *item = &grid->items[entry->id];
+        if (item->query_stamp == grid->query_stamp)
+            continue;
+        item->query_stamp = grid->query_stamp;
+        if (item->rect.max.x >= rect.min.x && item->rect.min.x <= rect.max.x &&
+            item->rect.max.y >= rect.min.y && item->rect.min.y <= rect.max.y) {
+            result->ids[result->count++] = entry->id;
+        }
+    }
+}
+
+internal Spatial_Grid_Result
+spatial_grid_query_rect(Arena *arena, Spatial_Grid *grid, Rng2_f32 rect) {
+    Spatial_Grid_Result     result = {0};
+    Spatial_Grid_Cell_Range cells = spatial_grid_cell_range(grid, rect);
+
+    grid->query_stamp += 1;
+    if (grid->query_stamp == 0) {
+        for (u32 i = 0; i < grid->item_cap; i++) {
+            grid->items[i].query_stamp = 0;
+        }
+        grid->query_stamp = 1;
+    }
+
+    // Reserve the worst case up front; results are at most item_cap ids
+    result.ids = push_array(arena, u32, Max(grid->item_cap, 1));
+
+    // Probing every cell in the rect costs a hash lookup each, empty or not.
+    // When the rect spans more cells than are occupied, walk those instead.
+    u64 rect_cells = (u64)((s64)cells.x1 - cells.x0 + 1) * (u64)((s64)cells.y1 - cells.y0 + 1);
+    if (rect_cells > grid->occupied_count) {
+        for (Spatial_Grid_Cell *cell = grid->first_occupied; cell; cell = cell->occupied_next) {
+            if (cell->x >= cells.x0 && cell->x <= cells.x1 && cell->y >= cells.y0 && cell->y <= cells.y1) {
+                spatial_grid_query_cell(grid, cell, rect, &result);
+            }
+        }
+    } else {
+        for (s32 y = cells.y0; y <= cells.y1; y++) {
+            for (s32 x = cells.x0; x <= cells.x1; x++) {
+                Spatial_Grid_Cell *cell = spatial_grid_cell_from_coord(grid, x, y, 0);
+                if (cell) {
+                    spatial_grid_query_cell(grid, cell, rect, &result);
+                }
+            }
+        }
+    }
+    return result;
+}
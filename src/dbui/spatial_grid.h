@@ -0,0 +1,66 @@
+#pragma once
+#include "../base/base_inc.h"
+
+// Uniform grid over axis-aligned rects keyed by a dense u32 id (the node index).
+// Cells are hashed so the world is unbounded; an item is linked into every cell
+// its rect overlaps, and updates only relink when the covered cell range changes.
+// Non-empty cells are also kept on an occupied list, so queries over a wide,
+// mostly empty rect (zoomed out) visit only the cells that hold something.
+
+typedef struct Spatial_Grid_Entry Spatial_Grid_Entry;
+struct Spatial_Grid_Entry {
+    Spatial_Grid_Entry *next;
+    u32                 id;
+};
+
+typedef struct Spatial_Grid_Cell Spatial_Grid_Cell;
+struct Spatial_Grid_Cell {
+    Spatial_Grid_Cell  *hash_next;
+    Spatial_Grid_Cell  *occupied_next;
+    Spatial_Grid_Cell  *occupied_prev;
+    s32                 x;
+    s32                 y;
+    Spatial_Grid_Entry *first;
+};
+
+typedef struct Spatial_Grid_Cell_Range Spatial_Grid_Cell_Range;
+struct Spatial_Grid_Cell_Range {
+    s32 x0, y0, x1, y1; // Inclusive
+};
+
+typedef struct Spatial_Grid_Item Spatial_Grid_Item;
+struct Spatial_Grid_Item {
+    Rng2_f32                rect;
+    Spatial_Grid_Cell_Range cells;
+    u32                     query_stamp;
+    b32                     is_live;
+};
+
+typedef struct Spatial_Grid Spatial_Grid;
+struct Spatial_Grid {
+    Arena              *arena;
+    f32                 cell_size;
+    u64                 slots_count;
+    Spatial_Grid_Cell **slots;
+    Spatial_Grid_Cell  *first_occupied;
+    Spatial_Grid_Cell  *last_occupied;
+    u64                 occupied_count;
+    Spatial_Grid_Entry *free_entries;
+    Spatial_Grid_Item  *items;
+    u32                 item_cap;
+    u32                 query_stamp;
+};
+
+typedef struct Spatial_Grid_Result Spatial_Grid_Result;
+struct Spatial_Grid_Result {
+    u32 *ids;
+    u32  count;
+};
+
+internal Spatial_Grid       *spatial_grid_alloc(f32 cell_size, u32 item_cap);
+internal void                spatial_grid_release(Spatial_Grid *grid);
+internal void                spatial_grid_insert(Spatial_Grid *grid, u32 id, Rng2_f32 rect);
+internal void                spatial_grid_update(Spatial_Grid *grid, u32 id, Rng2_f32 rect);
+internal void                spatial_grid_remove(Spatial_Grid *grid, u32 id);
+internal s64                 spatial_grid_pick(Spatial_Grid *grid, Vec2_f32 point);
+internal Spatial_Grid_Result spatial_grid_query_rect(Arena *arena, Spatial_Grid *grid, Rng2_f32 rect);
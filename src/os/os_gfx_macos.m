@@ -851,6 +851,39 @@ os_event_list_from_window(OS_Handle window)
                     }
                     result.count++;
                 }
+
+                // Typed text after the press, printable ASCII only. Command
+                // chords are shortcuts, their characters aren't typed.
+                NSString *characters = [event characters];
+                if (!([event modifierFlags] & NSEventModifierFlagCommand))
+                {
+                    for (NSUInteger i = 0; i < [characters length]; i++)
+                    {
+                        unichar ch = [characters characterAtIndex:i];
+                        if (ch < 0x20 || ch >= 0x7F)
+                            continue;
+
+                        OS_Event *os_event = push_array_zero(frame_arena, OS_Event, 1);
+                        os_event->window = window;
+                        os_event->kind = OS_Event_Text;
+                        os_event->key = OS_Key_Null;
+                        os_event->character = (u32)ch;
+                        os_event->modifiers = os_modifiers_from_macos_flags([event modifierFlags]);
+                        os_event->next = NULL;
+                        os_event->prev = result.last;
+
+                        if (result.last)
+                        {
+                            result.last->next = os_event;
+                            result.last = os_event;
+                        }
+                        else
+                        {
+                            result.first = result.last = os_event;
+                        }
+                        result.count++;
+                    }
+                }
             }
             break;
 
@@ -856,6 +856,28 @@ os_event_list_from_window(OS_Handle window) {
                 }
                 result.count++;
             }
+
+            // Typed text after the press, printable ASCII only
+            char   text[8];
+            KeySym keysym;
+            s32    text_size = XLookupString(&event.xkey, text, sizeof(text), &keysym, 0);
+            if (text_size == 1 && (u8)text[0] >= 0x20 && (u8)text[0] < 0x7F) {
+                Arena    *arena = arena_alloc();
+                OS_Event *os_event = push_array(arena, OS_Event, 1);
+                os_event->window = window;
+                os_event->kind = OS_Event_Text;
+                os_event->character = (u8)text[0];
+                os_event->modifiers = os_modifiers_from_x11_state(event.xkey.state);
+
+                if (result.last) {
+                    result.last->next = os_event;
+                    os_event->prev = result.last;
+                    result.last = os_event;
+                } else {
+                    result.first = result.last = os_event;
+                }
+                result.count++;
+            }
         } break;
 
         case KeyRelease: {
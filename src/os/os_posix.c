@@ -612,8 +612,10 @@ os_semaphore_create(u32 initial_count) {
     dispatch_semaphore_t *dsem = (dispatch_semaphore_t *)&sem.u64s[0];
     *dsem = dispatch_semaphore_create(initial_count);
 #else
-    sem_t *psem = (sem_t *)&sem.u64s[0];
+    // Handles are copied by value, so the sem_t itself has to live elsewhere
+    sem_t *psem = (sem_t *)malloc(sizeof(sem_t));
     sem_init(psem, 0, initial_count);
+    sem.u64s[0] = (u64)psem;
 #endif
 
     return sem;
@@ -627,8 +629,11 @@ os_semaphore_destroy(Semaphore sem) {
         dispatch_release(*dsem);
     }
 #else
-    sem_t *psem = (sem_t *)&sem.u64s[0];
-    sem_destroy(psem);
+    sem_t *psem = (sem_t *)sem.u64s[0];
+    if (psem) {
+        sem_destroy(psem);
+        free(psem);
+    }
 #endif
 }
 
@@ -638,7 +643,7 @@ os_semaphore_wait(Semaphore sem) {
     dispatch_semaphore_t *dsem = (dispatch_semaphore_t *)&sem.u64s[0];
     dispatch_semaphore_wait(*dsem, DISPATCH_TIME_FOREVER);
 #else
-    sem_t *psem = (sem_t *)&sem.u64s[0];
+    sem_t *psem = (sem_t *)sem.u64s[0];
     sem_wait(psem);
 #endif
 }
@@ -650,7 +655,7 @@ os_semaphore_wait_timeout(Semaphore sem, u32 timeout_ms) {
     dispatch_time_t       timeout = dispatch_time(DISPATCH_TIME_NOW, timeout_ms * NSEC_PER_MSEC);
     return dispatch_semaphore_wait(*dsem, timeout) == 0;
 #else
-    sem_t          *psem = (sem_t *)&sem.u64s[0];
+    sem_t          *psem = (sem_t *)sem.u64s[0];
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
     ts.tv_sec += timeout_ms / 1000;
@@ -669,7 +674,7 @@ os_semaphore_signal(Semaphore sem) {
     dispatch_semaphore_t *dsem = (dispatch_semaphore_t *)&sem.u64s[0];
     dispatch_semaphore_signal(*dsem);
 #else
-    sem_t *psem = (sem_t *)&sem.u64s[0];
+    sem_t *psem = (sem_t *)sem.u64s[0];
     sem_post(psem);
 #endif
 }
@@ -677,59 +682,67 @@ os_semaphore_signal(Semaphore sem) {
 internal Mutex
 os_mutex_create(void) {
     Mutex            mutex = {0};
-    pthread_mutex_t *pmutex = (pthread_mutex_t *)&mutex.u64s[0];
+    pthread_mutex_t *pmutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
     pthread_mutex_init(pmutex, NULL);
+    mutex.u64s[0] = (u64)pmutex;
     return mutex;
 }
 
 internal void
 os_mutex_destroy(Mutex mutex) {
-    pthread_mutex_t *pmutex = (pthread_mutex_t *)&mutex.u64s[0];
-    pthread_mutex_destroy(pmutex);
+    pthread_mutex_t *pmutex = (pthread_mutex_t *)mutex.u64s[0];
+    if (pmutex) {
+        pthread_mutex_destroy(pmutex);
+        free(pmutex);
+    }
 }
 
 internal void
 os_mutex_lock(Mutex mutex) {
-    pthread_mutex_t *pmutex = (pthread_mutex_t *)&mutex.u64s[0];
+    pthread_mutex_t *pmutex = (pthread_mutex_t *)mutex.u64s[0];
     pthread_mutex_lock(pmutex);
 }
 
 internal void
 os_mutex_unlock(Mutex mutex) {
-    pthread_mutex_t *pmutex = (pthread_mutex_t *)&mutex.u64s[0];
+    pthread_mutex_t *pmutex = (pthread_mutex_t *)mutex.u64s[0];
     pthread_mutex_unlock(pmutex);
 }
 
 internal CondVar
 os_condvar_create(void) {
     CondVar         cv = {0};
-    pthread_cond_t *pcond = (pthread_cond_t *)&cv.u64s[0];
+    pthread_cond_t *pcond = (pthread_cond_t *)malloc(sizeof(pthread_cond_t));
     pthread_cond_init(pcond, NULL);
+    cv.u64s[0] = (u64)pcond;
     return cv;
 }
 
 internal void
 os_condvar_destroy(CondVar cv) {
-    pthread_cond_t *pcond = (pthread_cond_t *)&cv.u64s[0];
-    pthread_cond_destroy(pcond);
+    pthread_cond_t *pcond = (pthread_cond_t *)cv.u64s[0];
+    if (pcond) {
+        pthread_cond_destroy(pcond);
+        free(pcond);
+    }
 }
 
 internal void
 os_condvar_wait(CondVar cv, Mutex mutex) {
-    pthread_cond_t  *pcond = (pthread_cond_t *)&cv.u64s[0];
-    pthread_mutex_t *pmutex = (pthread_mutex_t *)&mutex.u64s[0];
+    pthread_cond_t  *pcond = (pthread_cond_t *)cv.u64s[0];
+    pthread_mutex_t *pmutex = (pthread_mutex_t *)mutex.u64s[0];
     pthread_cond_wait(pcond, pmutex);
 }
 
 internal void
 os_condvar_signal(CondVar cv) {
-    pthread_cond_t *pcond = (pthread_cond_t *)&cv.u64s[0];
+    pthread_cond_t *pcond = (pthread_cond_t *)cv.u64s[0];
     pthread_cond_signal(pcond);
 }
 
 internal void
 os_condvar_broadcast(CondVar cv) {
-    pthread_cond_t *pcond = (pthread_cond_t *)&cv.u64s[0];
+    pthread_cond_t *pcond = (pthread_cond_t *)cv.u64s[0];
     pthread_cond_broadcast(pcond);
 }
 
@@ -760,8 +773,9 @@ os_barrier_create(u32 thread_count) {
     barrier.ptr[0] = b;
 #else
     // Linux has native pthread_barrier
-    pthread_barrier_t *pbarrier = (pthread_barrier_t *)&barrier.u64s[0];
+    pthread_barrier_t *pbarrier = (pthread_barrier_t *)malloc(sizeof(pthread_barrier_t));
     pthread_barrier_init(pbarrier, NULL, thread_count);
+    barrier.u64s[0] = (u64)pbarrier;
 #endif
 
     return barrier;
@@ -777,8 +791,11 @@ os_barrier_destroy(Barrier barrier) {
         free(b);
     }
 #else
-    pthread_barrier_t *pbarrier = (pthread_barrier_t *)&barrier.u64s[0];
-    pthread_barrier_destroy(pbarrier);
+    pthread_barrier_t *pbarrier = (pthread_barrier_t *)barrier.u64s[0];
+    if (pbarrier) {
+        pthread_barrier_destroy(pbarrier);
+        free(pbarrier);
+    }
 #endif
 }
 
@@ -808,7 +825,7 @@ os_barrier_wait(Barrier barrier) {
 
     pthread_mutex_unlock(&b->mutex);
 #else
-    pthread_barrier_t *pbarrier = (pthread_barrier_t *)&barrier.u64s[0];
+    pthread_barrier_t *pbarrier = (pthread_barrier_t *)barrier.u64s[0];
     pthread_barrier_wait(pbarrier);
 #endif
 }
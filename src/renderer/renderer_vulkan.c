@@ -742,10 +742,12 @@ void renderer_shutdown() {
     // Destroy pipelines
     if (g_vulkan->pipelines.ui)
         vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.ui, NULL);
-    if (g_vulkan->pipelines.blur_horizontal)
-        vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.blur_horizontal, NULL);
-    if (g_vulkan->pipelines.blur_vertical && g_vulkan->pipelines.blur_vertical != g_vulkan->pipelines.blur_horizontal)
-        vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.blur_vertical, NULL);
+    if (g_vulkan->pipelines.blur_down)
+        vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.blur_down, NULL);
+    if (g_vulkan->pipelines.blur_up)
+        vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.blur_up, NULL);
+    if (g_vulkan->pipelines.blur_composite)
+        vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.blur_composite, NULL);
     if (g_vulkan->pipelines.geo_3d)
         vkDestroyPipeline(g_vulkan->device, g_vulkan->pipelines.geo_3d, NULL);
 
@@ -848,6 +850,7 @@ void renderer_vulkan_recreate_swapchain(Renderer_Vulkan_Window_Equipment *equip)
     vkDestroyImageView(g_vulkan->device, equip->depth_image_view, NULL);
     vkDestroyImage(g_vulkan->device, equip->depth_image, NULL);
     vkFreeMemory(g_vulkan->device, equip->depth_image_memory, NULL);
+    renderer_vulkan_destroy_blur_levels(equip);
 
     // Keep old swapchain for creation
     VkSwapchainKHR old_swapchain = equip->swapchain;
@@ -902,6 +905,12 @@ void renderer_vulkan_recreate_swapchain(Renderer_Vulkan_Window_Equipment *equip)
     swapchain_info.imageArrayLayers = 1;
     swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+    // The blur pass blits the region under the blur rect out of the swapchain image
+    equip->blur_supported = (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (equip->blur_supported) {
+        swapchain_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
     u32 queue_family_indices[] = {g_vulkan->graphics_queue_family, g_vulkan->present_queue_family};
     if (g_vulkan->graphics_queue_family != g_vulkan->present_queue_family) {
         swapchain_info.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
@@ -975,6 +984,59 @@ void renderer_vulkan_recreate_swapchain(Renderer_Vulkan_Window_Equipment *equip)
             return;
         }
     }
+
+    renderer_vulkan_create_blur_levels(equip);
+}
+
+void renderer_vulkan_create_blur_levels(Renderer_Vulkan_Window_Equipment *equip) {
+    if (!equip->blur_supported || !equip->blur_render_pass)
+        return;
+
+    for (u32 i = 0; i < RENDERER_VULKAN_BLUR_LEVEL_MAX; i++) {
+        Renderer_Vulkan_Blur_Level *level = &equip->blur_levels[i];
+        level->extent.width = Max(equip->swapchain_extent.width >> (i + 1), 1u);
+        level->extent.height = Max(equip->swapchain_extent.height >> (i + 1), 1u);
+
+        // Level 0 is filled by a blit from the swapchain image, the rest are render targets only
+        renderer_vulkan_create_image(level->extent.width, level->extent.height,
+                                     equip->swapchain_format, VK_IMAGE_TILING_OPTIMAL,
+                                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                                         VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     &level->image, &level->memory);
+        level->view = renderer_vulkan_create_image_view(level->image, equip->swapchain_format,
+                                                        VK_IMAGE_ASPECT_COLOR_BIT);
+
+        VkFramebufferCreateInfo framebuffer_info = {0};
+        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_info.renderPass = equip->blur_render_pass;
+        framebuffer_info.attachmentCount = 1;
+        framebuffer_info.pAttachments = &level->view;
+        framebuffer_info.width = level->extent.width;
+        framebuffer_info.height = level->extent.height;
+        framebuffer_info.layers = 1;
+
+        if (vkCreateFramebuffer(g_vulkan->device, &framebuffer_info, NULL, &level->framebuffer) != VK_SUCCESS) {
+            log_error("Failed to create blur framebuffer!");
+            equip->blur_supported = 0;
+            return;
+        }
+    }
+}
+
+void renderer_vulkan_destroy_blur_levels(Renderer_Vulkan_Window_Equipment *equip) {
+    for (u32 i = 0; i < RENDERER_VULKAN_BLUR_LEVEL_MAX; i++) {
+        Renderer_Vulkan_Blur_Level *level = &equip->blur_levels[i];
+        if (level->framebuffer)
+            vkDestroyFramebuffer(g_vulkan->device, level->framebuffer, NULL);
+        if (level->view)
+            vkDestroyImageView(g_vulkan->device, level->view, NULL);
+        if (level->image)
+            vkDestroyImage(g_vulkan->device, level->image, NULL);
+        if (level->memory)
+            vkFreeMemory(g_vulkan->device, level->memory, NULL);
+        MemoryZeroStruct(level);
+    }
 }
 
 // Window equipment functions
@@ -1130,6 +1192,12 @@ renderer_window_equip(OS_Handle window_handle) {
     swapchain_info.imageArrayLayers = 1;
     swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+    // The blur pass blits the region under the blur rect out of the swapchain image
+    equip->blur_supported = (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (equip->blur_supported) {
+        swapchain_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
     u32 queue_family_indices[] = {g_vulkan->graphics_queue_family, g_vulkan->present_queue_family};
 
     if (g_vulkan->graphics_queue_family != g_vulkan->present_queue_family) {
@@ -1238,6 +1306,75 @@ renderer_window_equip(OS_Handle window_handle) {
         return renderer_handle_zero();
     }
 
+    // Resume pass: compatible with the main pass, but keeps the color contents the
+    // blur pass composited over. The swapchain image comes back from the blit as TRANSFER_SRC.
+    {
+        VkAttachmentDescription resume_attachments[] = {color_attachment, depth_attachment};
+        resume_attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        resume_attachments[0].initialLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        VkSubpassDependency resume_dependency = dependency;
+        resume_dependency.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        resume_dependency.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        resume_dependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+
+        VkRenderPassCreateInfo resume_info = render_pass_info;
+        resume_info.pAttachments = resume_attachments;
+        resume_info.pDependencies = &resume_dependency;
+
+        if (vkCreateRenderPass(g_vulkan->device, &resume_info, NULL, &equip->resume_render_pass) != VK_SUCCESS) {
+            log_error("Failed to create resume render pass!");
+            equip->blur_supported = 0;
+        }
+    }
+
+    // Blur pass: single color target per chain level, read by the next level's fragment shader
+    {
+        VkAttachmentDescription blur_attachment = {0};
+        blur_attachment.format = equip->swapchain_format;
+        blur_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        blur_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        blur_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        blur_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        blur_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        blur_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        blur_attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkSubpassDescription blur_subpass = {0};
+        blur_subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        blur_subpass.colorAttachmentCount = 1;
+        blur_subpass.pColorAttachments = &color_attachment_ref;
+
+        VkSubpassDependency blur_dependencies[2] = {0};
+        blur_dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        blur_dependencies[0].dstSubpass = 0;
+        blur_dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        blur_dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        blur_dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        blur_dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        blur_dependencies[1].srcSubpass = 0;
+        blur_dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        blur_dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        blur_dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        blur_dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        blur_dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo blur_info = {0};
+        blur_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        blur_info.attachmentCount = 1;
+        blur_info.pAttachments = &blur_attachment;
+        blur_info.subpassCount = 1;
+        blur_info.pSubpasses = &blur_subpass;
+        blur_info.dependencyCount = 2;
+        blur_info.pDependencies = blur_dependencies;
+
+        if (vkCreateRenderPass(g_vulkan->device, &blur_info, NULL, &equip->blur_render_pass) != VK_SUCCESS) {
+            log_error("Failed to create blur render pass!");
+            equip->blur_supported = 0;
+        }
+    }
+
     // Create depth resources
     renderer_vulkan_create_image(equip->swapchain_extent.width, equip->swapchain_extent.height,
                                  VK_FORMAT_D32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
@@ -1271,6 +1408,8 @@ renderer_window_equip(OS_Handle window_handle) {
         }
     }
 
+    renderer_vulkan_create_blur_levels(equip);
+
     // Allocate command buffers
     VkCommandBufferAllocateInfo alloc_info = {0};
     alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1305,8 +1444,8 @@ renderer_window_equip(OS_Handle window_handle) {
 
     // Create pipelines if not already created
     if (g_vulkan->pipelines.ui == VK_NULL_HANDLE) {
-        void renderer_vulkan_create_pipelines(VkRenderPass render_pass);
-        renderer_vulkan_create_pipelines(equip->render_pass);
+        void renderer_vulkan_create_pipelines(VkRenderPass render_pass, VkRenderPass blur_render_pass);
+        renderer_vulkan_create_pipelines(equip->render_pass, equip->blur_render_pass);
     }
 
     // Allocate descriptor sets for each frame (array already sized)
@@ -1358,22 +1497,11 @@ void renderer_window_unequip(OS_Handle window_handle, Renderer_Handle window_equ
     vkDeviceWaitIdle(g_vulkan->device);
 
     // Cleanup blur resources
-    if (equip->blur_framebuffer_a)
-        vkDestroyFramebuffer(g_vulkan->device, equip->blur_framebuffer_a, NULL);
-    if (equip->blur_framebuffer_b)
-        vkDestroyFramebuffer(g_vulkan->device, equip->blur_framebuffer_b, NULL);
-    if (equip->blur_texture_a_view)
-        vkDestroyImageView(g_vulkan->device, equip->blur_texture_a_view, NULL);
-    if (equip->blur_texture_b_view)
-        vkDestroyImageView(g_vulkan->device, equip->blur_texture_b_view, NULL);
-    if (equip->blur_texture_a)
-        vkDestroyImage(g_vulkan->device, equip->blur_texture_a, NULL);
-    if (equip->blur_texture_b)
-        vkDestroyImage(g_vulkan->device, equip->blur_texture_b, NULL);
-    if (equip->blur_texture_a_memory)
-        vkFreeMemory(g_vulkan->device, equip->blur_texture_a_memory, NULL);
-    if (equip->blur_texture_b_memory)
-        vkFreeMemory(g_vulkan->device, equip->blur_texture_b_memory, NULL);
+    renderer_vulkan_destroy_blur_levels(equip);
+    if (equip->blur_render_pass)
+        vkDestroyRenderPass(g_vulkan->device, equip->blur_render_pass, NULL);
+    if (equip->resume_render_pass)
+        vkDestroyRenderPass(g_vulkan->device, equip->resume_render_pass, NULL);
 
     // Cleanup synchronization
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
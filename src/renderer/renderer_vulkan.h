@@ -63,8 +63,9 @@ struct Renderer_Vulkan_State {
     struct
     {
         VkPipeline ui;
-        VkPipeline blur_horizontal;
-        VkPipeline blur_vertical;
+        VkPipeline blur_down;
+        VkPipeline blur_up;
+        VkPipeline blur_composite;
         VkPipeline geo_3d;
     } pipelines;
 
@@ -95,6 +96,17 @@ struct Renderer_Vulkan_State {
     VkDeviceMemory white_texture_memory;
 };
 
+#define RENDERER_VULKAN_BLUR_LEVEL_MAX 6
+
+typedef struct Renderer_Vulkan_Blur_Level Renderer_Vulkan_Blur_Level;
+struct Renderer_Vulkan_Blur_Level {
+    VkImage        image;
+    VkImageView    view;
+    VkDeviceMemory memory;
+    VkFramebuffer  framebuffer;
+    VkExtent2D     extent;
+};
+
 typedef struct Renderer_Vulkan_Window_Equipment Renderer_Vulkan_Window_Equipment;
 struct Renderer_Vulkan_Window_Equipment {
     VkSurfaceKHR   surface;
@@ -124,16 +136,12 @@ struct Renderer_Vulkan_Window_Equipment {
     u32         current_image_index;
     b32         frame_begun;
 
-    // Blur framebuffers
-    VkImage        blur_texture_a;
-    VkImageView    blur_texture_a_view;
-    VkDeviceMemory blur_texture_a_memory;
-    VkFramebuffer  blur_framebuffer_a;
-
-    VkImage        blur_texture_b;
-    VkImageView    blur_texture_b_view;
-    VkDeviceMemory blur_texture_b_memory;
-    VkFramebuffer  blur_framebuffer_b;
+    // Dual-filter blur chain. Level i is (extent >> (i + 1)) and only the
+    // region under the blur rect is ever rendered into.
+    b32                        blur_supported;
+    VkRenderPass               blur_render_pass;
+    VkRenderPass               resume_render_pass; // Main pass with LOAD_OP_LOAD, used after a blur
+    Renderer_Vulkan_Blur_Level blur_levels[RENDERER_VULKAN_BLUR_LEVEL_MAX];
 
     // Descriptor sets per frame
     struct Frame_Resources {
@@ -185,6 +193,8 @@ VkImageView
 void renderer_vulkan_transition_image_layout(VkImage image, VkFormat format,
                                              VkImageLayout old_layout, VkImageLayout new_layout);
 void renderer_vulkan_copy_buffer_to_image(VkBuffer buffer, VkImage image, u32 width, u32 height);
+void renderer_vulkan_create_blur_levels(Renderer_Vulkan_Window_Equipment *equip);
+void renderer_vulkan_destroy_blur_levels(Renderer_Vulkan_Window_Equipment *equip);
 VkCommandBuffer
      renderer_vulkan_begin_single_time_commands();
 void renderer_vulkan_end_single_time_commands(VkCommandBuffer command_buffer);
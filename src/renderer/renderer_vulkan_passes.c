@@ -13,6 +13,9 @@ struct Dynamic_Buffer {
 
 static Dynamic_Buffer g_instance_buffer = {0};
 
+// Bytes of the frame's uniform slice already handed out to blur steps
+static u64 g_blur_uniform_offset = 0;
+
 // Uniform buffer structures
 typedef struct UI_Uniforms UI_Uniforms;
 struct UI_Uniforms {
@@ -28,6 +31,31 @@ struct Geo_3D_Uniforms {
     Mat4x4_f32 projection;
 };
 
+// Matches Blur_Uniforms in blur.frag (std140)
+typedef struct Blur_Uniforms Blur_Uniforms;
+struct Blur_Uniforms {
+    Vec4_f32 src_uv_rect;
+    Vec2_f32 src_texel;
+    Vec2_f32 dst_size;
+    Vec4_f32 rect;
+    Vec4_f32 corner_radii;
+    f32      offset;
+    s32      mode;
+    f32      _pad[2];
+};
+
+typedef enum Blur_Mode {
+    Blur_Mode_Down = 0,
+    Blur_Mode_Up = 1,
+    Blur_Mode_Composite = 2,
+} Blur_Mode;
+
+// Integer pixel region, max exclusive
+typedef struct Blur_Region Blur_Region;
+struct Blur_Region {
+    s32 x0, y0, x1, y1;
+};
+
 // Forward declarations
 void renderer_vulkan_submit_ui_pass(VkCommandBuffer cmd, Renderer_Pass_Params_UI *params,
                                     Renderer_Vulkan_Window_Equipment *equip);
@@ -46,6 +74,8 @@ void renderer_window_submit(OS_Handle window, Renderer_Handle window_equip, Rend
 
     // Reset instance buffer offset for new frame
     g_instance_buffer.offset = 0;
+    // Blur steps take their uniforms from the start of this frame's slice again
+    g_blur_uniform_offset = 0;
 
     // Begin render pass
     VkRenderPassBeginInfo render_pass_info = {0};
@@ -307,15 +337,320 @@ void renderer_vulkan_submit_ui_pass(VkCommandBuffer cmd, Renderer_Pass_Params_UI
     }
 }
 
+static Blur_Region
+blur_region_scale_down(Blur_Region r, u32 shift, VkExtent2D extent) {
+    Blur_Region result = {0};
+    s32         div = 1 << shift;
+    result.x0 = r.x0 / div;
+    result.y0 = r.y0 / div;
+    result.x1 = Min((r.x1 + div - 1) / div, (s32)extent.width);
+    result.y1 = Min((r.y1 + div - 1) / div, (s32)extent.height);
+    return result;
+}
+
+static VkRect2D
+blur_region_to_rect(Blur_Region r) {
+    VkRect2D result = {0};
+    result.offset.x = r.x0;
+    result.offset.y = r.y0;
+    result.extent.width = (u32)(r.x1 - r.x0);
+    result.extent.height = (u32)(r.y1 - r.y0);
+    return result;
+}
+
+static Vec4_f32
+blur_region_to_uv_rect(Blur_Region r, VkExtent2D extent) {
+    // Inset by half a texel so bilinear taps never reach outside the filled region
+    Vec4_f32 result = {0};
+    result.x = ((f32)r.x0 + 0.5f) / (f32)extent.width;
+    result.y = ((f32)r.y0 + 0.5f) / (f32)extent.height;
+    result.z = ((f32)r.x1 - 0.5f) / (f32)extent.width;
+    result.w = ((f32)r.y1 - 0.5f) / (f32)extent.height;
+    return result;
+}
+
+static void
+blur_image_barrier(VkCommandBuffer cmd, VkImage image,
+                   VkImageLayout old_layout, VkImageLayout new_layout,
+                   VkAccessFlags src_access, VkAccessFlags dst_access,
+                   VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage) {
+    VkImageMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = src_access;
+    barrier.dstAccessMask = dst_access;
+
+    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+// Writes one step's uniforms, binds a fresh descriptor set for it and draws the
+// fullscreen triangle. Viewport covers the whole target so gl_FragCoord / dst_size
+// maps to the same uv on every level; the scissor limits work to the region.
+static b32
+blur_draw_step(VkCommandBuffer cmd, Renderer_Vulkan_Window_Equipment *equip, VkPipeline pipeline,
+               Blur_Uniforms *uniforms, VkImageView src_view, VkExtent2D dst_extent, Blur_Region dst_region) {
+    struct Frame_Resources *frame = &equip->frame_resources[equip->current_frame];
+
+    // UI and geo 3D uniforms live in the first KB of the frame's slice
+    u64 uniform_offset = frame->uniform_offset + KB(1) + g_blur_uniform_offset;
+    if (KB(1) + g_blur_uniform_offset + sizeof(Blur_Uniforms) > KB(256)) {
+        log_error("Out of blur uniform space for this frame");
+        return 0;
+    }
+    g_blur_uniform_offset += AlignPow2(sizeof(Blur_Uniforms), 256);
+    memcpy((u8 *)g_vulkan->uniform_buffer.mapped + uniform_offset, uniforms, sizeof(*uniforms));
+
+    VkDescriptorSet             set = VK_NULL_HANDLE;
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = g_vulkan->descriptor_pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &g_vulkan->descriptor_set_layouts.blur_global;
+    if (vkAllocateDescriptorSets(g_vulkan->device, &alloc_info, &set) != VK_SUCCESS) {
+        log_error("Failed to allocate blur descriptor set!");
+        return 0;
+    }
+
+    VkDescriptorBufferInfo buffer_info = {0};
+    buffer_info.buffer = g_vulkan->uniform_buffer.buffer;
+    buffer_info.offset = uniform_offset;
+    buffer_info.range = sizeof(Blur_Uniforms);
+
+    VkDescriptorImageInfo image_info = {0};
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_info.imageView = src_view;
+    image_info.sampler = g_vulkan->sampler_linear;
+
+    VkWriteDescriptorSet writes[2] = {0};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[0].descriptorCount = 1;
+    writes[0].pBufferInfo = &buffer_info;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[1].descriptorCount = 1;
+    writes[1].pImageInfo = &image_info;
+
+    vkUpdateDescriptorSets(g_vulkan->device, 2, writes, 0, NULL);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, g_vulkan->pipeline_layouts.blur,
+                            0, 1, &set, 0, NULL);
+
+    VkViewport viewport = {0};
+    viewport.width = (f32)dst_extent.width;
+    viewport.height = (f32)dst_extent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor = blur_region_to_rect(dst_region);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+    return 1;
+}
+
+static void
+blur_begin_level_pass(VkCommandBuffer cmd, Renderer_Vulkan_Window_Equipment *equip, u32 level, Blur_Region region) {
+    VkRenderPassBeginInfo begin_info = {0};
+    begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    begin_info.renderPass = equip->blur_render_pass;
+    begin_info.framebuffer = equip->blur_levels[level].framebuffer;
+    begin_info.renderArea = blur_region_to_rect(region);
+    vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+}
+
 void renderer_vulkan_submit_blur_pass(VkCommandBuffer cmd, Renderer_Pass_Params_Blur *params,
                                       Renderer_Vulkan_Window_Equipment *equip) {
     ZoneScopedN("VulkanSubmitBlurPass");
-    // TODO: Implement blur pass
-    // This typically involves:
-    // 1. Rendering to an offscreen texture
-    // 2. Horizontal blur pass
-    // 3. Vertical blur pass
-    // 4. Composite back to main framebuffer
+    // Dual-filter blur restricted to the blur rect:
+    // 1. Leave the main pass and blit the padded region into level 0 (half res)
+    // 2. Downsample level i -> i + 1, then upsample back to level 0
+    // 3. Resume the main pass and composite level 0 (with a final upsample tap)
+    //    into the rect, masked by the corner radii
+    // Cost is bounded by the region at half resolution, independent of blur_size.
+    if (!equip->blur_supported || !equip->resume_render_pass || !g_vulkan->pipelines.blur_composite ||
+        params->blur_size <= 0.0f) {
+        return;
+    }
+
+    f32        scale = equip->dpi_scale > 0 ? equip->dpi_scale : 1.0f;
+    VkExtent2D extent = equip->swapchain_extent;
+
+    // Visible part of the rect, in physical pixels
+    Blur_Region dst = {0};
+    dst.x0 = (s32)floorf(Max(params->rect.min.x, params->clip.min.x) * scale);
+    dst.y0 = (s32)floorf(Max(params->rect.min.y, params->clip.min.y) * scale);
+    dst.x1 = (s32)ceilf(Min(params->rect.max.x, params->clip.max.x) * scale);
+    dst.y1 = (s32)ceilf(Min(params->rect.max.y, params->clip.max.y) * scale);
+    dst.x0 = Clamp(0, dst.x0, (s32)extent.width);
+    dst.y0 = Clamp(0, dst.y0, (s32)extent.height);
+    dst.x1 = Clamp(0, dst.x1, (s32)extent.width);
+    dst.y1 = Clamp(0, dst.y1, (s32)extent.height);
+    if (dst.x1 <= dst.x0 || dst.y1 <= dst.y0) {
+        return;
+    }
+
+    // Each iteration roughly doubles the radius; pick the level count from blur_size
+    // and spread the remainder into the sample offset.
+    f32 blur_px = params->blur_size * scale;
+    u32 level_count = 1;
+    while (level_count < RENDERER_VULKAN_BLUR_LEVEL_MAX && (f32)(2u << level_count) < blur_px) {
+        level_count += 1;
+    }
+    f32 offset = Clamp(1.0f, blur_px / (f32)(2u << level_count), 4.0f);
+
+    // Pad the processed region by the kernel footprint so edges sample real content
+    s32         pad = (s32)ceilf((f32)(2u << level_count) * (offset + 1.0f));
+    Blur_Region src = dst;
+    src.x0 = Max(src.x0 - pad, 0);
+    src.y0 = Max(src.y0 - pad, 0);
+    src.x1 = Min(src.x1 + pad, (s32)extent.width);
+    src.y1 = Min(src.y1 + pad, (s32)extent.height);
+
+    Blur_Region level_regions[RENDERER_VULKAN_BLUR_LEVEL_MAX];
+    for (u32 i = 0; i < level_count; i++) {
+        level_regions[i] = blur_region_scale_down(src, i + 1, equip->blur_levels[i].extent);
+        if (level_regions[i].x1 <= level_regions[i].x0 || level_regions[i].y1 <= level_regions[i].y0) {
+            level_count = i;
+            break;
+        }
+    }
+    if (level_count == 0) {
+        return;
+    }
+
+    VkImage swapchain_image = equip->swapchain_images[equip->current_image_index];
+
+    vkCmdEndRenderPass(cmd);
+
+    // 1. Blit padded region into level 0 (the blit's linear filter is the first 2x downsample)
+    {
+        Renderer_Vulkan_Blur_Level *level0 = &equip->blur_levels[0];
+        Blur_Region                 r0 = level_regions[0];
+
+        blur_image_barrier(cmd, swapchain_image,
+                           VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        blur_image_barrier(cmd, level0->image,
+                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkImageBlit blit = {0};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.layerCount = 1;
+        blit.srcOffsets[0].x = r0.x0 * 2;
+        blit.srcOffsets[0].y = r0.y0 * 2;
+        blit.srcOffsets[1].x = Min(r0.x1 * 2, (s32)extent.width);
+        blit.srcOffsets[1].y = Min(r0.y1 * 2, (s32)extent.height);
+        blit.srcOffsets[1].z = 1;
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.layerCount = 1;
+        blit.dstOffsets[0].x = r0.x0;
+        blit.dstOffsets[0].y = r0.y0;
+        blit.dstOffsets[1].x = r0.x1;
+        blit.dstOffsets[1].y = r0.y1;
+        blit.dstOffsets[1].z = 1;
+
+        vkCmdBlitImage(cmd,
+                       swapchain_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       level0->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit, VK_FILTER_LINEAR);
+
+        blur_image_barrier(cmd, level0->image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+
+    // 2. Down the chain, then back up to level 0. A failed step leaves its level
+    // unwritten, so the rest of the chain and the composite are skipped.
+    b32 ok = 1;
+    for (u32 i = 1; i < level_count && ok; i++) {
+        Renderer_Vulkan_Blur_Level *src_level = &equip->blur_levels[i - 1];
+        Renderer_Vulkan_Blur_Level *dst_level = &equip->blur_levels[i];
+
+        Blur_Uniforms uniforms = {0};
+        uniforms.src_uv_rect = blur_region_to_uv_rect(level_regions[i - 1], src_level->extent);
+        uniforms.src_texel = (Vec2_f32){{1.0f / (f32)src_level->extent.width, 1.0f / (f32)src_level->extent.height}};
+        uniforms.dst_size = (Vec2_f32){{(f32)dst_level->extent.width, (f32)dst_level->extent.height}};
+        uniforms.offset = offset;
+        uniforms.mode = Blur_Mode_Down;
+
+        blur_begin_level_pass(cmd, equip, i, level_regions[i]);
+        ok = blur_draw_step(cmd, equip, g_vulkan->pipelines.blur_down, &uniforms, src_level->view,
+                            dst_level->extent, level_regions[i]);
+        vkCmdEndRenderPass(cmd);
+    }
+
+    for (u32 i = level_count - 1; i > 0 && ok; i--) {
+        Renderer_Vulkan_Blur_Level *src_level = &equip->blur_levels[i];
+        Renderer_Vulkan_Blur_Level *dst_level = &equip->blur_levels[i - 1];
+
+        Blur_Uniforms uniforms = {0};
+        uniforms.src_uv_rect = blur_region_to_uv_rect(level_regions[i], src_level->extent);
+        uniforms.src_texel = (Vec2_f32){{1.0f / (f32)src_level->extent.width, 1.0f / (f32)src_level->extent.height}};
+        uniforms.dst_size = (Vec2_f32){{(f32)dst_level->extent.width, (f32)dst_level->extent.height}};
+        uniforms.offset = offset;
+        uniforms.mode = Blur_Mode_Up;
+
+        blur_begin_level_pass(cmd, equip, i - 1, level_regions[i - 1]);
+        ok = blur_draw_step(cmd, equip, g_vulkan->pipelines.blur_up, &uniforms, src_level->view,
+                            dst_level->extent, level_regions[i - 1]);
+        vkCmdEndRenderPass(cmd);
+    }
+
+    // 3. Resume the main pass, later passes draw into it either way, and
+    // composite into the visible rect only
+    {
+        VkRenderPassBeginInfo render_pass_info = {0};
+        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        render_pass_info.renderPass = equip->resume_render_pass;
+        render_pass_info.framebuffer = equip->framebuffers[equip->current_image_index];
+        render_pass_info.renderArea.extent = extent;
+
+        VkClearValue clear_values[2] = {0};
+        clear_values[1].depthStencil.depth = 1.0f;
+        render_pass_info.clearValueCount = 2;
+        render_pass_info.pClearValues = clear_values;
+
+        vkCmdBeginRenderPass(cmd, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        if (!ok) {
+            return;
+        }
+
+        Renderer_Vulkan_Blur_Level *level0 = &equip->blur_levels[0];
+
+        Blur_Uniforms uniforms = {0};
+        uniforms.src_uv_rect = blur_region_to_uv_rect(level_regions[0], level0->extent);
+        uniforms.src_texel = (Vec2_f32){{1.0f / (f32)level0->extent.width, 1.0f / (f32)level0->extent.height}};
+        uniforms.dst_size = (Vec2_f32){{(f32)extent.width, (f32)extent.height}};
+        uniforms.rect = (Vec4_f32){{params->rect.min.x * scale, params->rect.min.y * scale,
+                                    params->rect.max.x * scale, params->rect.max.y * scale}};
+        uniforms.corner_radii = (Vec4_f32){{params->corner_radii[0] * scale, params->corner_radii[1] * scale,
+                                            params->corner_radii[2] * scale, params->corner_radii[3] * scale}};
+        uniforms.offset = offset;
+        uniforms.mode = Blur_Mode_Composite;
+
+        blur_draw_step(cmd, equip, g_vulkan->pipelines.blur_composite, &uniforms, level0->view, extent, dst);
+    }
 }
 
 void renderer_vulkan_submit_geo_3d_pass(VkCommandBuffer cmd, Renderer_Pass_Params_Geo_3D *params,
@@ -199,7 +199,7 @@ void renderer_vulkan_create_pipeline_layouts() {
     }
 }
 
-void renderer_vulkan_create_pipelines(VkRenderPass render_pass) {
+void renderer_vulkan_create_pipelines(VkRenderPass render_pass, VkRenderPass blur_render_pass) {
     VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
 
     // Common dynamic states
@@ -356,7 +356,7 @@ void renderer_vulkan_create_pipelines(VkRenderPass render_pass) {
         }
     }
 
-    // Create Blur Pipeline (simplified for now)
+    // Create Blur Pipelines (dual-filter down/up chain + composite)
     {
         VkPipelineShaderStageCreateInfo shader_stages[2] = {0};
         shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -410,7 +410,7 @@ void renderer_vulkan_create_pipelines(VkRenderPass render_pass) {
         depth_stencil.depthTestEnable = VK_FALSE;
         depth_stencil.depthWriteEnable = VK_FALSE;
 
-        // No blending for blur (renders to offscreen target)
+        // No blending for the down/up chain (renders to offscreen targets)
         VkPipelineColorBlendAttachmentState color_blend_attachment = {0};
         color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                                 VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -435,17 +435,36 @@ void renderer_vulkan_create_pipelines(VkRenderPass render_pass) {
         pipeline_info.pColorBlendState = &color_blending;
         pipeline_info.pDynamicState = &dynamic_state;
         pipeline_info.layout = g_vulkan->pipeline_layouts.blur;
-        pipeline_info.renderPass = render_pass;
+        pipeline_info.renderPass = blur_render_pass;
         pipeline_info.subpass = 0;
 
-        // Create both horizontal and vertical blur pipelines
-        if (vkCreateGraphicsPipelines(g_vulkan->device, pipeline_cache, 1, &pipeline_info,
-                                      NULL, &g_vulkan->pipelines.blur_horizontal) != VK_SUCCESS) {
-            assert(0 && "Failed to create horizontal blur graphics pipeline!");
+        // Down and up passes share the shader (mode is a uniform), but get separate
+        // pipeline objects so they can diverge without touching the submit code.
+        if (blur_render_pass) {
+            if (vkCreateGraphicsPipelines(g_vulkan->device, pipeline_cache, 1, &pipeline_info,
+                                          NULL, &g_vulkan->pipelines.blur_down) != VK_SUCCESS) {
+                assert(0 && "Failed to create blur downsample graphics pipeline!");
+            }
+            if (vkCreateGraphicsPipelines(g_vulkan->device, pipeline_cache, 1, &pipeline_info,
+                                          NULL, &g_vulkan->pipelines.blur_up) != VK_SUCCESS) {
+                assert(0 && "Failed to create blur upsample graphics pipeline!");
+            }
         }
 
-        // For now, use same pipeline for vertical blur
-        g_vulkan->pipelines.blur_vertical = g_vulkan->pipelines.blur_horizontal;
+        // Composite writes the final upsample into the main pass, masked by the rounded rect
+        color_blend_attachment.blendEnable = VK_TRUE;
+        color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+        color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        pipeline_info.renderPass = render_pass;
+
+        if (vkCreateGraphicsPipelines(g_vulkan->device, pipeline_cache, 1, &pipeline_info,
+                                      NULL, &g_vulkan->pipelines.blur_composite) != VK_SUCCESS) {
+            assert(0 && "Failed to create blur composite graphics pipeline!");
+        }
     }
 
     // Create Geo 3D Pipeline
@@ -1,8 +1,71 @@
 #version 450
 
-// TODO: Implement blur fragment shader
+// Dual-filter (dual Kawase) blur.
+// Every chain level covers the whole framebuffer at (extent >> (level + 1)),
+// so uv = gl_FragCoord / dst_size lines up between levels and only the
+// region under the blur rect is ever rasterized.
+
+layout(set = 0, binding = 0) uniform Blur_Uniforms {
+    vec4  src_uv_rect;  // Filled region of the source level (min.xy, max.xy), inset by half a texel
+    vec2  src_texel;    // 1 / source level size
+    vec2  dst_size;     // Size of the render target in pixels
+    vec4  rect;         // Composite only: blur rect in framebuffer pixels
+    vec4  corner_radii; // Composite only: 00, 01, 10, 11
+    float offset;       // Kawase sample offset in source texels
+    int   mode;         // 0 = downsample, 1 = upsample, 2 = composite
+} u;
+
+layout(set = 0, binding = 1) uniform sampler2D src_tex;
+
 layout(location = 0) out vec4 frag_color;
 
+vec4 sample_src(vec2 uv) {
+    return texture(src_tex, clamp(uv, u.src_uv_rect.xy, u.src_uv_rect.zw));
+}
+
+vec4 downsample(vec2 uv, vec2 hp) {
+    vec4 sum = sample_src(uv) * 4.0;
+    sum += sample_src(uv - hp);
+    sum += sample_src(uv + hp);
+    sum += sample_src(uv + vec2(hp.x, -hp.y));
+    sum += sample_src(uv - vec2(hp.x, -hp.y));
+    return sum / 8.0;
+}
+
+vec4 upsample(vec2 uv, vec2 hp) {
+    vec4 sum = sample_src(uv + vec2(-hp.x * 2.0, 0.0));
+    sum += sample_src(uv + vec2(-hp.x, hp.y)) * 2.0;
+    sum += sample_src(uv + vec2(0.0, hp.y * 2.0));
+    sum += sample_src(uv + vec2(hp.x, hp.y)) * 2.0;
+    sum += sample_src(uv + vec2(hp.x * 2.0, 0.0));
+    sum += sample_src(uv + vec2(hp.x, -hp.y)) * 2.0;
+    sum += sample_src(uv + vec2(0.0, -hp.y * 2.0));
+    sum += sample_src(uv + vec2(-hp.x, -hp.y)) * 2.0;
+    return sum / 12.0;
+}
+
+float rounded_rect_sdf(vec2 p, vec2 center, vec2 half_size, float r) {
+    vec2 d = abs(p - center) - half_size + vec2(r);
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0)) - r;
+}
+
 void main() {
-    frag_color = vec4(1.0, 0.0, 1.0, 1.0); // Placeholder magenta
-}
\ No newline at end of file
+    vec2 uv = gl_FragCoord.xy / u.dst_size;
+    vec2 hp = u.src_texel * 0.5 * u.offset;
+
+    if (u.mode == 0) {
+        frag_color = downsample(uv, hp);
+    } else if (u.mode == 1) {
+        frag_color = upsample(uv, hp);
+    } else {
+        vec4  color = upsample(uv, hp);
+        vec2  p = gl_FragCoord.xy;
+        vec2  center = (u.rect.xy + u.rect.zw) * 0.5;
+        vec2  half_size = (u.rect.zw - u.rect.xy) * 0.5;
+        vec2  side = step(center, p);
+        float r = mix(mix(u.corner_radii.x, u.corner_radii.y, side.y),
+                      mix(u.corner_radii.z, u.corner_radii.w, side.y), side.x);
+        float dist = rounded_rect_sdf(p, center, half_size, r);
+        frag_color = vec4(color.rgb, 1.0 - smoothstep(-0.5, 0.5, dist));
+    }
+}
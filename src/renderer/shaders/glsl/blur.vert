@@ -1,6 +1,6 @@
 #version 450
 
-// Fullscreen triangle
+// Fullscreen triangle; the blur passes restrict rasterization with the scissor
 void main() {
     vec2 positions[3] = vec2[3](
         vec2(-1.0, -1.0),
@@ -10,4 +10,4 @@ void main() {
     
     vec2 pos = positions[gl_VertexIndex];
     gl_Position = vec4(pos, 0.0, 1.0);
-}
\ No newline at end of file
+}